@@ -0,0 +1,199 @@
+/* Pack black and white PNGs into a single image bundle.
+
+   Usage:
+
+      ./pack_bundle {output.bundle} {input.png}...
+
+   Input file names determine how each image is split into cells.  Files
+   named "{name}-table-{w}-{h}.png" are split into cells of w*h pixels in
+   row-major order, same as Playdate image tables.  All other files are
+   packed as a single cell named "{name}".
+
+   Pixels with gray value >= 128 are white, and pixels with alpha >= 128
+   are opaque.  See ../source/bundle_format.h for output format.
+*/
+
+#include<png.h>
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+
+#include"../source/bundle_format.h"
+
+/* Check struct sizes, since we write these structs to file as is. */
+typedef char CheckHeaderSize[
+   sizeof(BundleHeader) == BUNDLE_HEADER_SIZE ? 1 : -1];
+typedef char CheckEntrySize[
+   sizeof(BundleEntry) == BUNDLE_ENTRY_SIZE ? 1 : -1];
+
+/* Loaded image, in gray+alpha format. */
+typedef struct
+{
+   png_image image;
+   png_bytep pixels;
+} Image;
+
+/* Parse image name and cell size from file name.  Returns 0 on success. */
+static int ParseName(const char *path, const png_image *image,
+                     BundleEntry *entry)
+{
+   const char *base, *suffix;
+   int length, w, h;
+
+   base = strrchr(path, '/');
+   base = base == NULL ? path : base + 1;
+
+   suffix = strstr(base, "-table-");
+   if( suffix != NULL )
+   {
+      if( sscanf(suffix, "-table-%d-%d.png", &w, &h) != 2 ||
+          w < 1 || h < 1 ||
+          (int)(image->width) % w != 0 ||
+          (int)(image->height) % h != 0 )
+      {
+         fprintf(stderr, "%s: Invalid table dimension\n", path);
+         return 1;
+      }
+   }
+   else
+   {
+      suffix = strstr(base, ".png");
+      if( suffix == NULL )
+      {
+         fprintf(stderr, "%s: Not a PNG file name\n", path);
+         return 1;
+      }
+      w = image->width;
+      h = image->height;
+   }
+
+   length = suffix - base;
+   if( length < 1 || length >= BUNDLE_NAME_SIZE )
+   {
+      fprintf(stderr, "%s: Invalid name length\n", path);
+      return 1;
+   }
+   memset(entry->name, 0, BUNDLE_NAME_SIZE);
+   memcpy(entry->name, base, length);
+   entry->width = w;
+   entry->height = h;
+   entry->count = (image->width / w) * (image->height / h);
+   entry->row_bytes = BUNDLE_ROW_BYTES(w);
+   entry->is_table = strstr(base, "-table-") != NULL;
+   return 0;
+}
+
+/* Write pixel data for all cells of a single image. */
+static void WriteCells(const Image *input, const BundleEntry *entry,
+                       FILE *outfile)
+{
+   const int plane_size = entry->row_bytes * entry->height;
+   const int columns = input->image.width / entry->width;
+   unsigned char *cell = calloc(2 * plane_size, 1);
+   int i, x, y, cell_x, cell_y;
+   png_bytep p;
+
+   for(i = 0; i < entry->count; i++)
+   {
+      memset(cell, 0, 2 * plane_size);
+      cell_x = (i % columns) * entry->width;
+      cell_y = (i / columns) * entry->height;
+      for(y = 0; y < entry->height; y++)
+      {
+         for(x = 0; x < entry->width; x++)
+         {
+            p = input->pixels +
+                2 * ((cell_y + y) * input->image.width + cell_x + x);
+            if( p[0] >= 128 )
+               cell[y * entry->row_bytes + x / 8] |= 0x80 >> (x % 8);
+            if( p[1] >= 128 )
+            {
+               cell[plane_size + y * entry->row_bytes + x / 8] |=
+                  0x80 >> (x % 8);
+            }
+         }
+      }
+      fwrite(cell, 2 * plane_size, 1, outfile);
+   }
+   free(cell);
+}
+
+int main(int argc, char **argv)
+{
+   BundleHeader header;
+   BundleEntry *entry;
+   Image *input;
+   FILE *outfile;
+   int count, i;
+   uint32_t offset;
+
+   if( argc < 3 )
+   {
+      fprintf(stderr, "%s {output.bundle} {input.png}...\n", *argv);
+      return 1;
+   }
+   count = argc - 2;
+   if( count > 0xffff )
+   {
+      fputs("Too many input files\n", stderr);
+      return 1;
+   }
+
+   /* Load all input images and build index. */
+   input = calloc(count, sizeof(Image));
+   entry = calloc(count, sizeof(BundleEntry));
+   offset = sizeof(BundleHeader) + count * sizeof(BundleEntry);
+   for(i = 0; i < count; i++)
+   {
+      input[i].image.version = PNG_IMAGE_VERSION;
+      if( !png_image_begin_read_from_file(&input[i].image, argv[i + 2]) )
+      {
+         fprintf(stderr, "%s: %s\n", argv[i + 2], input[i].image.message);
+         return 1;
+      }
+      input[i].image.format = PNG_FORMAT_GA;
+      input[i].pixels = malloc(PNG_IMAGE_SIZE(input[i].image));
+      if( input[i].pixels == NULL )
+      {
+         fputs("Out of memory\n", stderr);
+         return 1;
+      }
+      if( !png_image_finish_read(&input[i].image, NULL, input[i].pixels,
+                                 0, NULL) )
+      {
+         fprintf(stderr, "%s: %s\n", argv[i + 2], input[i].image.message);
+         return 1;
+      }
+      if( ParseName(argv[i + 2], &input[i].image, entry + i) != 0 )
+         return 1;
+
+      entry[i].offset = offset;
+      offset += 2 * entry[i].count * entry[i].row_bytes * entry[i].height;
+   }
+
+   memset(&header, 0, sizeof(header));
+   memcpy(header.magic, BUNDLE_MAGIC, sizeof(header.magic));
+   header.version = BUNDLE_VERSION;
+   header.entry_count = count;
+   header.file_size = offset;
+
+   /* Write output. */
+   outfile = fopen(argv[1], "wb");
+   if( outfile == NULL )
+   {
+      fprintf(stderr, "Error writing %s\n", argv[1]);
+      return 1;
+   }
+   fwrite(&header, sizeof(header), 1, outfile);
+   fwrite(entry, sizeof(BundleEntry), count, outfile);
+   for(i = 0; i < count; i++)
+   {
+      WriteCells(input + i, entry + i, outfile);
+      free(input[i].pixels);
+   }
+   fclose(outfile);
+
+   free(input);
+   free(entry);
+   return 0;
+}
@@ -0,0 +1,83 @@
+#!/bin/bash
+
+if [[ $# -ne 1 ]]; then
+   echo "$0 {pack_bundle.exe}"
+   exit 1
+fi
+TOOL=$1
+TEST_DIR=$(mktemp -d)
+
+set -euo pipefail
+
+function die
+{
+   echo "$1"
+   rm -rf "$TEST_DIR"
+   exit 1
+}
+
+# Create input table with two 4x2 cells.
+# Pixels (W=white, B=black, -=transparent):
+#   W B W -  B B B W
+#   - - - -  B B B B
+cat > "$TEST_DIR/pixels.pgm" <<PGM
+P2
+8 2
+255
+255 0 255 0  0 0 0 255
+0 0 0 0      0 0 0 0
+PGM
+cat > "$TEST_DIR/alpha.pgm" <<PGM
+P2
+8 2
+255
+255 255 255 0  255 255 255 255
+0 0 0 0        255 255 255 255
+PGM
+pnmtopng -alpha="$TEST_DIR/alpha.pgm" "$TEST_DIR/pixels.pgm" \
+   > "$TEST_DIR/t-table-4-2.png"
+
+# Create a single white pixel image.
+cat > "$TEST_DIR/pixel.pgm" <<PGM
+P2
+1 1
+255
+255
+PGM
+pnmtopng -alpha="$TEST_DIR/pixel.pgm" "$TEST_DIR/pixel.pgm" \
+   > "$TEST_DIR/s.png"
+
+# Build expected output.
+perl -e 'print pack("a4 v v V", "SLBN", 1, 2, 116),
+               pack("a16 v6 V", "t", 4, 2, 2, 4, 1, 0, 76),
+               pack("a16 v6 V", "s", 1, 1, 1, 4, 0, 0, 108),
+               # Table cell 0: pixels, then mask.
+               pack("C16", 0xa0, 0, 0, 0,  0, 0, 0, 0,
+                           0xe0, 0, 0, 0,  0, 0, 0, 0),
+               # Table cell 1: pixels, then mask.
+               pack("C16", 0x10, 0, 0, 0,  0, 0, 0, 0,
+                           0xf0, 0, 0, 0,  0xf0, 0, 0, 0),
+               # Single image.
+               pack("C8", 0x80, 0, 0, 0,  0x80, 0, 0, 0);' \
+   > "$TEST_DIR/expected.bundle"
+
+"./$TOOL" "$TEST_DIR/actual.bundle" \
+   "$TEST_DIR/t-table-4-2.png" "$TEST_DIR/s.png"
+if ! ( cmp "$TEST_DIR/expected.bundle" "$TEST_DIR/actual.bundle" ); then
+   od -An -tx1 -v "$TEST_DIR/expected.bundle" > "$TEST_DIR/expected.txt"
+   od -An -tx1 -v "$TEST_DIR/actual.bundle" > "$TEST_DIR/actual.txt"
+   diff "$TEST_DIR/expected.txt" "$TEST_DIR/actual.txt" || true
+   die "FAIL: $LINENO: output mismatched"
+fi
+
+# Check invalid table dimensions.
+cp "$TEST_DIR/t-table-4-2.png" "$TEST_DIR/u-table-3-2.png"
+"./$TOOL" "$TEST_DIR/actual.bundle" "$TEST_DIR/u-table-3-2.png" \
+   2> "$TEST_DIR/error.txt" && die "$LINENO: unexpected success"
+if ! ( grep -qF "Invalid table dimension" "$TEST_DIR/error.txt" ); then
+   die "$LINENO: missing error message"
+fi
+
+# Cleanup.
+rm -rf "$TEST_DIR"
+exit 0
@@ -1,191 +1,293 @@
 #include"bgm.h"
 #include"common.h"
+#include"log_ring.h"
+#include"refresh.h"
 
-// File player handle.
+// Background music file.  BGM_FILE is the name of the compiled file in the
+// package, used for reporting file size.
+//
+// MP3 costs less space, while IMA-ADPCM costs less CPU to decode.  See
+// "BGM" variable in Makefile.
+#if BGM_ADPCM
+   #define BGM_PATH  "in_the_hall_of_the_mountain_king_adpcm"
+   #define BGM_FILE  BGM_PATH ".pda"
+#else
+   #define BGM_PATH  "in_the_hall_of_the_mountain_king"
+   #define BGM_FILE  BGM_PATH ".mp3"
+#endif
+
+// File player handle.  This is non-NULL if music is playing or if the
+// player has been prepared by PrepareBackgroundMusic.
 static FilePlayer *g_fileplayer = NULL;
 
-// Song time states.  We maintain our own time because fileplayer->getOffset
-// is unreliable.
-//
-// The lesson learned here is that you can't really synchronize
-// something to music unless you are doing your own synth.
-static uint64_t g_last_update_time_ms;
-static uint32_t g_song_time_ms;
+// Nonzero if g_fileplayer has started playing.
+static int g_playing = 0;
+
+#ifndef NDEBUG
+// Sample clock at the time of the play call, for measuring the delay
+// until the first audible sample.  Set to zero after the measurement.
+static uint32_t g_play_time = 0;
+#endif
+
+// Song time is measured using the audio engine's sample clock, relative
+// to the sample clock value when playback started.  fileplayer->getOffset
+// is unreliable, and accumulating getCurrentTimeMilliseconds deltas drifts
+// away from the audio whenever a frame takes too long.
+static uint32_t g_song_start_time;
+
+// Convert song timestamp in seconds to sample clock offset.  This is a
+// constant expression, so the conversion happens at build time.
+#define SONG_TIME(seconds)    ((uint32_t)((seconds) * SAMPLE_RATE + 0.5))
+
+// Number of samples to look ahead when checking for beats.  Beats are
+// observed once per frame, so without any look ahead, a beat would be
+// delayed by up to a full frame.  Looking ahead by half a frame means each
+// beat lands on the frame nearest to it, which halves the worst case
+// error to half a frame in either direction.
+#define BEAT_LOOK_AHEAD       (SAMPLE_RATE / SIMULATION_RATE / 2)
+
+// Number of samples to look ahead for GetUpcomingSongPhase.
+#define PHASE_LOOK_AHEAD      (SAMPLE_RATE * 2)
 
 typedef struct
 {
-   float timestamp;
+   // Sample clock offset from start of song.
+   uint32_t timestamp;
    int beat;
 } BeatData;
 static const BeatData kSongBeats[] =
 {
    // Tree phase.
-   {12.336, 0},
-   {21.200, 1},
-   {30.009, 2},
-   {39.006, 3},
-   {48.004, 4},
-   {56.911, 5},
+   {SONG_TIME(12.336), 0},
+   {SONG_TIME(21.200), 1},
+   {SONG_TIME(30.009), 2},
+   {SONG_TIME(39.006), 3},
+   {SONG_TIME(48.004), 4},
+   {SONG_TIME(56.911), 5},
 
    // Rock phase.
-   {58.008, 5 | (1 << 16)},  // No meteor at start of phase.
-   {58.588, 6 | (1 << 16)},
-   {59.642, 7 | (1 << 16)},
-   {61.743, 8 | (1 << 16)},
-   {62.829, 9 | (1 << 16)},
-   {63.842, 10 | (1 << 16)},
-   {64.844, 11 | (1 << 16)},
-   {65.392, 12 | (1 << 16)},
-
-   {66.942, 13 | (1 << 16)},
-   {67.934, 14 | (1 << 16)},
-   {68.925, 15 | (1 << 16)},
-   {69.948, 16 | (1 << 16)},
-   {70.929, 17 | (1 << 16)},
-   {71.952, 18 | (1 << 16)},
-   {72.923, 19 | (1 << 16)},
-   {73.914, 20 | (1 << 16)},
-
-   {74.916, 21 | (1 << 16)},
-   {75.907, 22 | (1 << 16)},
-   {76.888, 23 | (1 << 16)},
-   {77.795, 24 | (1 << 16)},
-   {78.808, 25 | (1 << 16)},
-   {79.736, 26 | (1 << 16)},
-   {80.633, 27 | (1 << 16)},
-   {81.624, 28 | (1 << 16)},
-
-   {82.520, 29 | (1 << 16)},
-   {83.470, 30 | (1 << 16)},
-   {84.356, 31 | (1 << 16)},
-   {85.294, 32 | (1 << 16)},
-   {86.149, 33 | (1 << 16)},
-   {87.024, 34 | (1 << 16)},
-   {87.931, 35 | (1 << 16)},
-   {88.796, 36 | (1 << 16)},
-
-   {89.661, 37 | (1 << 16)},
-   {90.536, 38 | (1 << 16)},
-   {91.369, 39 | (1 << 16)},
-   {92.192, 40 | (1 << 16)},
-   {93.036, 41 | (1 << 16)},
-   {93.901, 42 | (1 << 16)},
-   {94.692, 43 | (1 << 16)},
-   {95.493, 44 | (1 << 16)},
-
-   {96.295, 45 | (1 << 16)},
-   {97.086, 46 | (1 << 16)},
-   {97.835, 47 | (1 << 16)},
-   {98.573, 48 | (1 << 16)},
-   {99.311, 49 | (1 << 16)},
-   {99.670, 50 | (1 << 16)},
-   {100.092, 51 | (1 << 16)},
-   {100.440, 52 | (1 << 16)},
-   {100.809, 53 | (1 << 16)},
-   {101.178, 54 | (1 << 16)},
-   {101.537, 55 | (1 << 16)},
+   {SONG_TIME(58.008), 5 | (1 << 16)},  // No meteor at start of phase.
+   {SONG_TIME(58.588), 6 | (1 << 16)},
+   {SONG_TIME(59.642), 7 | (1 << 16)},
+   {SONG_TIME(61.743), 8 | (1 << 16)},
+   {SONG_TIME(62.829), 9 | (1 << 16)},
+   {SONG_TIME(63.842), 10 | (1 << 16)},
+   {SONG_TIME(64.844), 11 | (1 << 16)},
+   {SONG_TIME(65.392), 12 | (1 << 16)},
+
+   {SONG_TIME(66.942), 13 | (1 << 16)},
+   {SONG_TIME(67.934), 14 | (1 << 16)},
+   {SONG_TIME(68.925), 15 | (1 << 16)},
+   {SONG_TIME(69.948), 16 | (1 << 16)},
+   {SONG_TIME(70.929), 17 | (1 << 16)},
+   {SONG_TIME(71.952), 18 | (1 << 16)},
+   {SONG_TIME(72.923), 19 | (1 << 16)},
+   {SONG_TIME(73.914), 20 | (1 << 16)},
+
+   {SONG_TIME(74.916), 21 | (1 << 16)},
+   {SONG_TIME(75.907), 22 | (1 << 16)},
+   {SONG_TIME(76.888), 23 | (1 << 16)},
+   {SONG_TIME(77.795), 24 | (1 << 16)},
+   {SONG_TIME(78.808), 25 | (1 << 16)},
+   {SONG_TIME(79.736), 26 | (1 << 16)},
+   {SONG_TIME(80.633), 27 | (1 << 16)},
+   {SONG_TIME(81.624), 28 | (1 << 16)},
+
+   {SONG_TIME(82.520), 29 | (1 << 16)},
+   {SONG_TIME(83.470), 30 | (1 << 16)},
+   {SONG_TIME(84.356), 31 | (1 << 16)},
+   {SONG_TIME(85.294), 32 | (1 << 16)},
+   {SONG_TIME(86.149), 33 | (1 << 16)},
+   {SONG_TIME(87.024), 34 | (1 << 16)},
+   {SONG_TIME(87.931), 35 | (1 << 16)},
+   {SONG_TIME(88.796), 36 | (1 << 16)},
+
+   {SONG_TIME(89.661), 37 | (1 << 16)},
+   {SONG_TIME(90.536), 38 | (1 << 16)},
+   {SONG_TIME(91.369), 39 | (1 << 16)},
+   {SONG_TIME(92.192), 40 | (1 << 16)},
+   {SONG_TIME(93.036), 41 | (1 << 16)},
+   {SONG_TIME(93.901), 42 | (1 << 16)},
+   {SONG_TIME(94.692), 43 | (1 << 16)},
+   {SONG_TIME(95.493), 44 | (1 << 16)},
+
+   {SONG_TIME(96.295), 45 | (1 << 16)},
+   {SONG_TIME(97.086), 46 | (1 << 16)},
+   {SONG_TIME(97.835), 47 | (1 << 16)},
+   {SONG_TIME(98.573), 48 | (1 << 16)},
+   {SONG_TIME(99.311), 49 | (1 << 16)},
+   {SONG_TIME(99.670), 50 | (1 << 16)},
+   {SONG_TIME(100.092), 51 | (1 << 16)},
+   {SONG_TIME(100.440), 52 | (1 << 16)},
+   {SONG_TIME(100.809), 53 | (1 << 16)},
+   {SONG_TIME(101.178), 54 | (1 << 16)},
+   {SONG_TIME(101.537), 55 | (1 << 16)},
 
    // Cloud phase.
-   {101.968, 55 | (2 << 16)},  // No meteor at start of phase.
-   {102.349, 56 | (2 << 16)},
-   {103.035, 57 | (2 << 16)},
-   {103.815, 58 | (2 << 16)},
-   {104.543, 59 | (2 << 16)},
-   {105.271, 60 | (2 << 16)},
-   {105.977, 61 | (2 << 16)},
-   {106.663, 62 | (2 << 16)},
-   {107.401, 63 | (2 << 16)},
-
-   {108.108, 64 | (2 << 16)},
-   {108.814, 65 | (2 << 16)},
-   {109.532, 66 | (2 << 16)},
-   {110.249, 67 | (2 << 16)},
-   {110.913, 68 | (2 << 16)},
-   {111.620, 69 | (2 << 16)},
-   {112.305, 70 | (2 << 16)},
-   {113.012, 71 | (2 << 16)},
-
-   {113.708, 72 | (2 << 16)},
-   {114.394, 73 | (2 << 16)},
-   {115.079, 74 | (2 << 16)},
-   {115.733, 75 | (2 << 16)},
-   {116.419, 76 | (2 << 16)},
-   {117.052, 77 | (2 << 16)},
-   {117.706, 78 | (2 << 16)},
-   {118.444, 79 | (2 << 16)},
-
-   {119.119, 80 | (2 << 16)},
-   {119.710, 81 | (2 << 16)},
-   {120.353, 82 | (2 << 16)},
-   {121.038, 83 | (2 << 16)},
-   {121.703, 84 | (2 << 16)},
-   {122.420, 85 | (2 << 16)},
-   {123.021, 86 | (2 << 16)},
-   {123.675, 87 | (2 << 16)},
-
-   {124.361, 88 | (2 << 16)},
-   {124.962, 89 | (2 << 16)},
-   {125.626, 90 | (2 << 16)},
-   {126.216, 91 | (2 << 16)},
-   {126.913, 92 | (2 << 16)},
-   {127.546, 93 | (2 << 16)},
-   {128.189, 94 | (2 << 16)},
-   {128.822, 95 | (2 << 16)},
-
-   {129.413, 96 | (2 << 16)},
-   {130.046, 97 | (2 << 16)},
-   {130.689, 98 | (2 << 16)},
-   {131.290, 99 | (2 << 16)},
-   {131.860, 100 | (2 << 16)},
-   {132.493, 101 | (2 << 16)},
-   {133.073, 102 | (2 << 16)},
-   {133.695, 103 | (2 << 16)},
+   {SONG_TIME(101.968), 55 | (2 << 16)},  // No meteor at start of phase.
+   {SONG_TIME(102.349), 56 | (2 << 16)},
+   {SONG_TIME(103.035), 57 | (2 << 16)},
+   {SONG_TIME(103.815), 58 | (2 << 16)},
+   {SONG_TIME(104.543), 59 | (2 << 16)},
+   {SONG_TIME(105.271), 60 | (2 << 16)},
+   {SONG_TIME(105.977), 61 | (2 << 16)},
+   {SONG_TIME(106.663), 62 | (2 << 16)},
+   {SONG_TIME(107.401), 63 | (2 << 16)},
+
+   {SONG_TIME(108.108), 64 | (2 << 16)},
+   {SONG_TIME(108.814), 65 | (2 << 16)},
+   {SONG_TIME(109.532), 66 | (2 << 16)},
+   {SONG_TIME(110.249), 67 | (2 << 16)},
+   {SONG_TIME(110.913), 68 | (2 << 16)},
+   {SONG_TIME(111.620), 69 | (2 << 16)},
+   {SONG_TIME(112.305), 70 | (2 << 16)},
+   {SONG_TIME(113.012), 71 | (2 << 16)},
+
+   {SONG_TIME(113.708), 72 | (2 << 16)},
+   {SONG_TIME(114.394), 73 | (2 << 16)},
+   {SONG_TIME(115.079), 74 | (2 << 16)},
+   {SONG_TIME(115.733), 75 | (2 << 16)},
+   {SONG_TIME(116.419), 76 | (2 << 16)},
+   {SONG_TIME(117.052), 77 | (2 << 16)},
+   {SONG_TIME(117.706), 78 | (2 << 16)},
+   {SONG_TIME(118.444), 79 | (2 << 16)},
+
+   {SONG_TIME(119.119), 80 | (2 << 16)},
+   {SONG_TIME(119.710), 81 | (2 << 16)},
+   {SONG_TIME(120.353), 82 | (2 << 16)},
+   {SONG_TIME(121.038), 83 | (2 << 16)},
+   {SONG_TIME(121.703), 84 | (2 << 16)},
+   {SONG_TIME(122.420), 85 | (2 << 16)},
+   {SONG_TIME(123.021), 86 | (2 << 16)},
+   {SONG_TIME(123.675), 87 | (2 << 16)},
+
+   {SONG_TIME(124.361), 88 | (2 << 16)},
+   {SONG_TIME(124.962), 89 | (2 << 16)},
+   {SONG_TIME(125.626), 90 | (2 << 16)},
+   {SONG_TIME(126.216), 91 | (2 << 16)},
+   {SONG_TIME(126.913), 92 | (2 << 16)},
+   {SONG_TIME(127.546), 93 | (2 << 16)},
+   {SONG_TIME(128.189), 94 | (2 << 16)},
+   {SONG_TIME(128.822), 95 | (2 << 16)},
+
+   {SONG_TIME(129.413), 96 | (2 << 16)},
+   {SONG_TIME(130.046), 97 | (2 << 16)},
+   {SONG_TIME(130.689), 98 | (2 << 16)},
+   {SONG_TIME(131.290), 99 | (2 << 16)},
+   {SONG_TIME(131.860), 100 | (2 << 16)},
+   {SONG_TIME(132.493), 101 | (2 << 16)},
+   {SONG_TIME(133.073), 102 | (2 << 16)},
+   {SONG_TIME(133.695), 103 | (2 << 16)},
 
    // Space phase.
-   {133.933, 103 | (3 << 16)},  // No meteor at start of phase.
-   {134.264, 104 | (3 << 16)},
-   {135.413, 106 | (3 << 16)},
-   {136.400, 108 | (3 << 16)},
+   {SONG_TIME(133.933), 103 | (3 << 16)},  // No meteor at start of phase.
+   {SONG_TIME(134.264), 104 | (3 << 16)},
+   {SONG_TIME(135.413), 106 | (3 << 16)},
+   {SONG_TIME(136.400), 108 | (3 << 16)},
 
-   {139.318, 110 | (3 << 16)},
-   {140.251, 112 | (3 << 16)},
+   {SONG_TIME(139.318), 110 | (3 << 16)},
+   {SONG_TIME(140.251), 112 | (3 << 16)},
 
-   {143.180, 114 | (3 << 16)},
-   {144.134, 116 | (3 << 16)},
+   {SONG_TIME(143.180), 114 | (3 << 16)},
+   {SONG_TIME(144.134), 116 | (3 << 16)},
 
-   {145.082, 118 | (3 << 16)},
-   {145.344, 120 | (3 << 16)},
-   {145.598, 122 | (3 << 16)},
-   {145.850, 124 | (3 << 16)},
-   {146.100, 126 | (3 << 16)},
-   {146.347, 128 | (3 << 16)},
-   {146.601, 130 | (3 << 16)},
+   {SONG_TIME(145.082), 118 | (3 << 16)},
+   {SONG_TIME(145.344), 120 | (3 << 16)},
+   {SONG_TIME(145.598), 122 | (3 << 16)},
+   {SONG_TIME(145.850), 124 | (3 << 16)},
+   {SONG_TIME(146.100), 126 | (3 << 16)},
+   {SONG_TIME(146.347), 128 | (3 << 16)},
+   {SONG_TIME(146.601), 130 | (3 << 16)},
 
-   {149.816, 138 | (3 << 16)},
+   {SONG_TIME(149.816), 138 | (3 << 16)},
 
    // End of song.  Timestamp here is bogus, we rely on isPlaying to
    // determine the true end of the song.  This is so that we will
    // hear the full song even if our time tracking is off.
-   {999.999, 138 | (4 << 16)}
+   {SONG_TIME(999.999), 138 | (4 << 16)}
 };
 static const int kSongBeatCount = sizeof(kSongBeats) / sizeof(BeatData);
 
 // Index into kSongBeats.
 static int g_song_cursor = 0;
 
-// Start playing background music.
-void PlayBackgroundMusic(PlaydateAPI *pd)
+// Queue of beat events that have not been consumed by PopBeatEvent.  At
+// most one beat happens per frame in practice, so a small queue is enough.
+// If the queue overflows, the oldest events are dropped.
+#define BEAT_QUEUE_SIZE 8
+static BeatEvent g_beat_queue[BEAT_QUEUE_SIZE];
+static int g_beat_queue_start = 0;
+static int g_beat_queue_size = 0;
+
+// Add an event to beat queue.
+static void PushBeatEvent(int beat, int lateness)
+{
+   if( g_beat_queue_size == BEAT_QUEUE_SIZE )
+   {
+      g_beat_queue_start = (g_beat_queue_start + 1) % BEAT_QUEUE_SIZE;
+      g_beat_queue_size--;
+   }
+   BeatEvent *event = &g_beat_queue[
+      (g_beat_queue_start + g_beat_queue_size) % BEAT_QUEUE_SIZE];
+   event->beat = beat;
+   event->lateness = lateness;
+   g_beat_queue_size++;
+}
+
+// Remove the oldest beat event.
+int PopBeatEvent(BeatEvent *event)
+{
+   if( g_beat_queue_size == 0 )
+      return 0;
+   *event = g_beat_queue[g_beat_queue_start];
+   g_beat_queue_start = (g_beat_queue_start + 1) % BEAT_QUEUE_SIZE;
+   g_beat_queue_size--;
+   return 1;
+}
+
+// Load background music without playing.
+void PrepareBackgroundMusic(PlaydateAPI *pd)
 {
    if( g_fileplayer != NULL )
       return;
+   #ifndef NDEBUG
+      const float start_time = pd->system->getElapsedTime();
+   #endif
+
    g_fileplayer = pd->sound->fileplayer->newPlayer();
-   pd->sound->fileplayer->loadIntoPlayer(
-      g_fileplayer, "in_the_hall_of_the_mountain_king");
+   pd->sound->fileplayer->loadIntoPlayer(g_fileplayer, BGM_PATH);
+   g_playing = 0;
+
+   #ifndef NDEBUG
+      LOG_EVENT("bgm: " BGM_FILE " prepared in %d us",
+                (int)((pd->system->getElapsedTime() - start_time) * 1e6f));
+   #endif
+}
+
+// Start playing background music.
+void PlayBackgroundMusic(PlaydateAPI *pd)
+{
+   if( g_playing )
+      return;
+   PrepareBackgroundMusic(pd);
+
+   #ifndef NDEBUG
+      const float start_time = pd->system->getElapsedTime();
+   #endif
+
    pd->sound->fileplayer->play(g_fileplayer, 1);
+   g_playing = 1;
 
+   #ifndef NDEBUG
+      LOG_EVENT("bgm: play call took %d us",
+                (int)((pd->system->getElapsedTime() - start_time) * 1e6f));
+      g_play_time = pd->sound->getCurrentTime();
+   #endif
+
+   g_song_start_time = pd->sound->getCurrentTime();
    g_song_cursor = 0;
-   g_song_time_ms = 0;
-   g_last_update_time_ms = pd->system->getCurrentTimeMilliseconds();
+   g_beat_queue_start = 0;
+   g_beat_queue_size = 0;
 }
 
 // Stop background music.
@@ -196,16 +298,17 @@ void PlayBackgroundMusic(PlaydateAPI *pd)
 // resume playback from a random time offset, as opposed to restart from the
 // beginning.  Calling setOffset appears to have no effect.
 //
-// Given that there is no reason to hold on to the resources when we aren't
-// playing anyways, we just recreate the fileplayer whenever we need to
-// start the background music.
+// So we recreate the fileplayer whenever we need to start the background
+// music from the beginning.  A player that was prepared but not yet
+// started is kept as is, since it's already positioned at the start.
 void StopBackgroundMusic(PlaydateAPI *pd)
 {
-   if( g_fileplayer == NULL )
+   if( g_fileplayer == NULL || !g_playing )
       return;
    pd->sound->fileplayer->stop(g_fileplayer);
    pd->sound->fileplayer->freePlayer(g_fileplayer);
    g_fileplayer = NULL;
+   g_playing = 0;
 }
 
 // Get current song phase.
@@ -214,42 +317,117 @@ int GetSongBeat(PlaydateAPI *pd)
    if( pd->sound->fileplayer->isPlaying(g_fileplayer) == 0 )
       return kSongBeats[kSongBeatCount - 1].beat;
 
-   // Update clocks.
-   const uint32_t current_time_ms = pd->system->getCurrentTimeMilliseconds();
-   const uint32_t delta_time_ms = current_time_ms - g_last_update_time_ms;
-   if( UNLIKELY(delta_time_ms < 0 || delta_time_ms > 1000) )
-      g_song_time_ms++;
-   else
-      g_song_time_ms += delta_time_ms;
-   g_last_update_time_ms = current_time_ms;
-
    #ifndef NDEBUG
-      const int previous_cursor = g_song_cursor;
+      // Measure delay between play call and the first sample, by
+      // subtracting the current playback offset from time elapsed since
+      // play.  getOffset is not accurate enough for tracking beats, but
+      // it's good enough to tell the order of magnitude here.
+      if( g_play_time != 0 )
+      {
+         const float offset = pd->sound->fileplayer->getOffset(g_fileplayer);
+         if( offset > 0 )
+         {
+            const uint32_t elapsed = pd->sound->getCurrentTime() - g_play_time;
+            LOG_EVENT("bgm: play to first sample latency = %d us",
+                      (int)((float)elapsed * (1e6f / SAMPLE_RATE) -
+                            offset * 1e6f));
+            g_play_time = 0;
+         }
+      }
    #endif
 
-   const float t = g_song_time_ms / 1000.0f;
+   // Sample clock is unsigned 32bit, so the subtraction is correct even
+   // if the clock wrapped around since start of song.
+   const uint32_t t = pd->sound->getCurrentTime() - g_song_start_time;
    while( g_song_cursor < kSongBeatCount &&
-          kSongBeats[g_song_cursor].timestamp < t )
+          kSongBeats[g_song_cursor].timestamp < t + BEAT_LOOK_AHEAD )
    {
+      const int lateness = (int)(t - kSongBeats[g_song_cursor].timestamp);
       g_song_cursor++;
+      PushBeatEvent(g_song_cursor >= kSongBeatCount
+                       ? kSongBeats[kSongBeatCount - 1].beat
+                       : kSongBeats[g_song_cursor].beat,
+                    lateness);
    }
 
-   #ifndef NDEBUG
-      // Log beat change to console.
-      if( previous_cursor != g_song_cursor )
-      {
-         pd->system->logToConsole(
-            "song_cursor: %d -> %d, time = %u, beat = %x",
-            previous_cursor,
-            g_song_cursor,
-            g_song_time_ms,
-            g_song_cursor >= kSongBeatCount
-               ? kSongBeats[kSongBeatCount - 1].beat
-               : kSongBeats[g_song_cursor].beat);
-      }
-   #endif
-
    if( g_song_cursor >= kSongBeatCount )
       return kSongBeats[kSongBeatCount - 1].beat;
    return kSongBeats[g_song_cursor].beat;
 }
+
+// Get song phase a few seconds from now.
+int GetUpcomingSongPhase(PlaydateAPI *pd)
+{
+   if( pd->sound->fileplayer->isPlaying(g_fileplayer) == 0 )
+      return kSongBeats[kSongBeatCount - 1].beat >> 16;
+
+   // Same as GetSongBeat, except we don't advance the cursor.
+   const uint32_t t = pd->sound->getCurrentTime() - g_song_start_time +
+                      PHASE_LOOK_AHEAD;
+   int cursor = g_song_cursor;
+   while( cursor < kSongBeatCount && kSongBeats[cursor].timestamp < t )
+      cursor++;
+   if( cursor >= kSongBeatCount )
+      return kSongBeats[kSongBeatCount - 1].beat >> 16;
+   return kSongBeats[cursor].beat >> 16;
+}
+
+// Get song beat without playing.
+int GetSongBeatAtTime(uint32_t t)
+{
+   if( t >= SONG_LENGTH )
+      return kSongBeats[kSongBeatCount - 1].beat;
+
+   // Same condition as GetSongBeat, which returns the first beat that is
+   // not within look ahead range.
+   for(int i = 0; i < kSongBeatCount; i++)
+   {
+      if( kSongBeats[i].timestamp >= t + BEAT_LOOK_AHEAD )
+         return kSongBeats[i].beat;
+   }
+   return kSongBeats[kSongBeatCount - 1].beat;
+}
+
+#if BGM_BENCHMARK
+
+// Duration of each benchmark run, in seconds.
+#define BENCHMARK_SECONDS  5
+
+// Count number of busy loop iterations that completed within benchmark
+// duration.
+static int CountBusyLoops(PlaydateAPI *pd)
+{
+   volatile int counter = 0;
+   int loops = 0;
+   const float start_time = pd->system->getElapsedTime();
+   while( pd->system->getElapsedTime() - start_time < BENCHMARK_SECONDS )
+   {
+      for(int i = 0; i < 1000; i++)
+         counter++;
+      loops++;
+   }
+   return loops;
+}
+
+// Measure decoding cost of background music.
+void BenchmarkBackgroundMusic(PlaydateAPI *pd)
+{
+   const int idle_loops = CountBusyLoops(pd);
+   PlayBackgroundMusic(pd);
+   const int playing_loops = CountBusyLoops(pd);
+   StopBackgroundMusic(pd);
+
+   // CPU time taken away from the busy loop while music is playing is the
+   // cost of decoding music.
+   const int cost_us = (int)((int64_t)(idle_loops - playing_loops) *
+                             1000000 / idle_loops);
+
+   FileStat stat;
+   const int size = pd->file->stat(BGM_FILE, &stat) == 0 ? (int)stat.size : -1;
+
+   pd->system->logToConsole(
+      "bgm: " BGM_FILE ", %d bytes, %d us CPU per audio second",
+      size, cost_us);
+}
+
+#endif  // BGM_BENCHMARK
@@ -5,16 +5,71 @@
 
 #include"pd_api.h"
 
-// Start background music.
+// Rate of the audio engine's sample clock, as returned by
+// sound->getCurrentTime.  This is independent of the sample rate of the
+// music file.
+#define SAMPLE_RATE  44100
+
+// Length of the song in samples (154.15 seconds).
+#define SONG_LENGTH  ((uint32_t)(SAMPLE_RATE * 15415 / 100))
+
+// A single beat change, see PopBeatEvent.
+typedef struct
+{
+   // Beat value returned by GetSongBeat after this change.
+   int beat;
+
+   // Number of samples between the scheduled time of the beat and the time
+   // when it was observed.  Negative values mean the beat was observed
+   // slightly early.
+   int lateness;
+} BeatEvent;
+
+// Load background music so that PlayBackgroundMusic only needs to start
+// playback.  This is called on an idle title screen frame, so that file
+// loading happens before the player presses the start button.  Calls after
+// the first one are no-ops until StopBackgroundMusic.
+void PrepareBackgroundMusic(PlaydateAPI *pd);
+
+// Start background music, preparing it first if needed.
 void PlayBackgroundMusic(PlaydateAPI *pd);
 
-// Stop background music.
+// Stop background music.  Call PrepareBackgroundMusic afterwards to
+// prepare for the next playback.
 void StopBackgroundMusic(PlaydateAPI *pd);
 
 // Get current song beat.  Returns a number where lower 16 bits is the song
 // beat, and upper 16 bits is the song phase.
 //
 // PlayBackgroundMusic must have been called first.
+//
+// Each beat that was passed since the previous call is also added to a
+// queue of beat events.
 int GetSongBeat(PlaydateAPI *pd);
 
+// Get song phase that will be reached two seconds from now, for loading
+// resources ahead of phase changes.  This does not add beat events.
+int GetUpcomingSongPhase(PlaydateAPI *pd);
+
+// Get song beat at a given number of samples from start of song, in the
+// same format as GetSongBeat.  This does not depend on playback state or
+// add beat events, and is meant for host tools that simulate a game
+// without audio.  Returns the end of song beat after SONG_LENGTH.
+int GetSongBeatAtTime(uint32_t t);
+
+#if BGM_BENCHMARK
+// Log file size and CPU cost per second of playback for the background
+// music format selected at build time.  This blocks for about 10 seconds,
+// and is meant to be called once during setup.
+//
+// CPU cost is measured as the slowdown of a busy loop while music is
+// playing.  This is only meaningful on the device, since the simulator
+// decodes audio on a separate thread.
+void BenchmarkBackgroundMusic(PlaydateAPI *pd);
+#endif
+
+// Remove the oldest beat event from queue.  Returns 1 if an event was
+// written to the output, 0 if queue is empty.
+int PopBeatEvent(BeatEvent *event);
+
 #endif  // BGM_H_
@@ -0,0 +1,83 @@
+// Image bundle file format, shared between the game and data/pack_bundle.c.
+//
+// A bundle consists of a BundleHeader, followed by entry_count BundleEntry
+// structs, followed by pixel data.  Each entry is an image table with
+// `count` cells of the same size, or a single image with count=1.  Cells
+// are numbered in row-major order of the source PNG, same as Playdate
+// image tables.  An image table and a single image may have the same
+// name, since those are separate namespaces for loadBitmapTable and
+// loadBitmap.
+//
+// Pixel data for each cell is height rows of pixels followed by height
+// rows of mask, each row being row_bytes long.  Pixels are 1 bit each,
+// most significant bit first, with 1 being white.  Mask bits are 1 for
+// opaque pixels.  row_bytes is always a multiple of 4, so all data offsets
+// are 4-byte aligned.
+//
+// All fields are little-endian.  This header only depends on stdint.h so
+// that it can be included from host tools.
+
+#ifndef BUNDLE_FORMAT_H_
+#define BUNDLE_FORMAT_H_
+
+#include<stdint.h>
+
+// Magic bytes at the start of bundle files.
+#define BUNDLE_MAGIC          "SLBN"
+
+// Format version.  Increment this whenever any of the structs change.
+#define BUNDLE_VERSION        1
+
+// Maximum length of entry names, including the terminating NUL.
+#define BUNDLE_NAME_SIZE      16
+
+// Expected struct sizes.
+#define BUNDLE_HEADER_SIZE    12
+#define BUNDLE_ENTRY_SIZE     (BUNDLE_NAME_SIZE + 16)
+
+// Number of bytes per row for a given width.
+#define BUNDLE_ROW_BYTES(width)  ((((width) + 31) / 32) * 4)
+
+typedef struct
+{
+   // BUNDLE_MAGIC, without the terminating NUL.
+   char magic[4];
+
+   // BUNDLE_VERSION.
+   uint16_t version;
+
+   // Number of BundleEntry structs following the header.
+   uint16_t entry_count;
+
+   // Total size of the bundle file in bytes.
+   uint32_t file_size;
+} BundleHeader;
+
+typedef struct
+{
+   // Image name, which is the PNG file name without the "-table-w-h.png"
+   // or ".png" suffix.  This is the same name that would be passed to
+   // loadBitmapTable or loadBitmap.
+   char name[BUNDLE_NAME_SIZE];
+
+   // Cell size in pixels.
+   uint16_t width;
+   uint16_t height;
+
+   // Number of cells.
+   uint16_t count;
+
+   // BUNDLE_ROW_BYTES(width).
+   uint16_t row_bytes;
+
+   // 1 if this entry came from a "-table-" file, 0 for single images.
+   uint16_t is_table;
+
+   // Always zero.
+   uint16_t reserved;
+
+   // Offset of the first cell from start of file.
+   uint32_t offset;
+} BundleEntry;
+
+#endif  // BUNDLE_FORMAT_H_
@@ -10,24 +10,25 @@
       // Standard assert() doesn't work with console because it requires
       // functions not available in the runtime library that's linked for the
       // device.  When targeting Playdate and assert() is enabled, we will do
-      // this hack to make it log to console instead.  This hack requires a
-      // pointer to the PlaydateAPI via the g_pd global variable, preferably
-      // assigned during setup.
+      // this hack to make it log to console instead.  Failed assertions are
+      // added to the log ring (see log_ring.h), which is flushed to console
+      // in idle frames, so that asserts in hot paths don't stall the frame.
+      // The whole message is a single string literal, so no formatting is
+      // needed until flush time.
       //
       // We could try to fix assert and get it to halt execution.  A logical
       // thing to try is pd->system->error(), but that appears to kill the
       // process without leaving error messages behind.  Another thing we
       // tried was implementing our own exception handler with setjmp/longjmp,
       // but that appears to crash in mysterious ways, and also doesn't leave
-      // any error messages behind.  All things considered, logToConsole will
-      // at least get us error messages when the device is connected.
-      #include"pd_api.h"
+      // any error messages behind.  All things considered, logging to console
+      // will at least get us error messages when the device is connected.
+      #include"log_ring.h"
 
-      extern PlaydateAPI *g_pd;
       #define assert(expr)  \
          ((expr) ? (void)0  \
-                 : g_pd->system->logToConsole("%s:%d: assertion failed: %s",  \
-                                              __FILE__, __LINE__, #expr))
+                 : AddLogText(__FILE__ ":" LOG_STRINGIFY(__LINE__)  \
+                              ": assertion failed: " #expr))
    #else
       #define assert(expr)    ((void)0)
    #endif
@@ -0,0 +1,124 @@
+#!/usr/bin/perl -w
+# Generate function ordering for link_map.ld from call counts.
+#
+# Usage:
+#
+#    nm call_profile.exe | perl generate_link_order.pl {call_counts.txt} -
+#
+# Input is call counts written by host/call_profile.c, and symbols from the
+# same executable to resolve function addresses.  Output is a linker script
+# fragment that lists functions sorted by number of calls, so that the
+# functions that run every frame are placed next to each other, instead of
+# being scattered among code that only runs at startup.  Functions that
+# were never called are left for link_map.ld to place as before.
+#
+# Device builds use -ffunction-sections, so each function is in its own
+# ".text.{name}" section.  Functions that were cloned or made local by
+# LTO may have an extra suffix, so we match those as well.  Functions that
+# got inlined on device simply won't match anything.
+
+use strict;
+
+# A function is in the hot set if it's called at least once per this
+# many frames on average.
+use constant HOT_FRAME_INTERVAL => 30;
+
+# Functions that run every frame on the device, but are not part of the
+# host build.  These are always placed at the start of the hot set.
+my @device_frame_functions = qw(
+   Update
+   UpdateGameInProgress
+   GetDirection
+   CheckLatencyProbe
+   UpdateLatencyProbe
+   LoadPendingImages
+   GetSimulationSteps
+   UpdateRefreshRate
+   GetSongBeat
+   GetUpcomingSongPhase
+   PopBeatEvent
+   PlaySlimeSoundEffects
+);
+
+if( $#ARGV != 1 )
+{
+   die "$0 {call_counts.txt} {nm_output.txt}\n";
+}
+my ($counts_file, $symbols_file) = @ARGV;
+
+# Load function addresses.
+my %names = ();
+my $base = undef;
+open my $symbols, "<$symbols_file" or die "$symbols_file: $!\n";
+while( my $line = <$symbols> )
+{
+   next unless $line =~ /^([[:xdigit:]]+)\s+[tTW]\s+(\S+)$/;
+   my ($address, $name) = (hex($1), $2);
+
+   # Drop suffixes for compiler-generated clones, e.g. "Min.constprop.0".
+   $name =~ s/\..*$//;
+   $names{$address} = $name;
+   if( $name eq "__cyg_profile_func_enter" )
+   {
+      $base = $address;
+   }
+}
+close $symbols;
+defined $base or die "$symbols_file: missing __cyg_profile_func_enter\n";
+
+# Load call counts.
+my %calls = ();
+open my $counts, "<$counts_file" or die "$counts_file: $!\n";
+while( my $line = <$counts> )
+{
+   $line =~ /^(-?\d+)\s+(\d+)$/ or die "$counts_file: syntax error: $line";
+   my $address = $base + $1;
+   exists $names{$address}
+      or die sprintf("$counts_file: unknown function at 0x%x\n", $address);
+   $calls{$names{$address}} += $2;
+}
+close $counts;
+
+# UpdateWorld runs once per frame, so its count is the frame count.
+my $frames = $calls{"UpdateWorld"} or die "$counts_file: no frames\n";
+
+my @hot = ();
+my @warm = ();
+foreach my $name (sort {$calls{$b} <=> $calls{$a} or $a cmp $b} keys %calls)
+{
+   if( $calls{$name} * HOT_FRAME_INTERVAL >= $frames )
+   {
+      push @hot, $name;
+   }
+   else
+   {
+      push @warm, $name;
+   }
+}
+
+# Write a single input section pattern.
+sub print_function($$)
+{
+   my ($name, $comment) = @_;
+   print "/* $comment */\n",
+         "*(.text.$name .text.$name.*)\n";
+}
+
+print "/* Generated by generate_link_order.pl, do not edit.  Run\n",
+      "   \"make link_order\" to regenerate from host/replays.\n\n",
+      "   Frames replayed: $frames */\n\n",
+      "__hot_text_start = .;\n";
+foreach my $name (@device_frame_functions)
+{
+   print_function($name, "$name: device only");
+}
+foreach my $name (@hot)
+{
+   print_function($name, sprintf("%s: %.2f calls/frame",
+                                 $name, $calls{$name} / $frames));
+}
+print "__hot_text_end = .;\n\n";
+foreach my $name (@warm)
+{
+   print_function($name, "$name: $calls{$name} calls");
+}
@@ -0,0 +1,93 @@
+#include"heap.h"
+#include<stddef.h>
+#include"log_ring.h"
+
+HeapStats g_heap_stats;
+int g_heap_guard;
+
+// Frame arena buffer.  Storage is declared as long long so that the start
+// is 8-byte aligned.
+static long long g_frame_arena[FRAME_ARENA_SIZE / sizeof(long long)];
+
+// Number of bytes used in frame arena since the last reset.
+static int g_frame_arena_used;
+
+// Allocate memory from frame arena.
+void *AllocateFrame(int size)
+{
+   const int aligned_size = (size + 7) & ~7;
+   if( aligned_size > FRAME_ARENA_SIZE - g_frame_arena_used )
+   {
+      #ifndef NDEBUG
+         g_heap_stats.frame_overflows++;
+         LOG_EVENT("memory: frame arena overflow, used = %d, requested = %d",
+                   g_frame_arena_used, size);
+      #endif
+      return NULL;
+   }
+
+   void *p = (char*)g_frame_arena + g_frame_arena_used;
+   g_frame_arena_used += aligned_size;
+   #ifndef NDEBUG
+      if( g_heap_stats.peak_frame_bytes < g_frame_arena_used )
+         g_heap_stats.peak_frame_bytes = g_frame_arena_used;
+   #endif
+   return p;
+}
+
+// Release all frame arena allocations.
+void ResetFrameArena(void)
+{
+   g_frame_arena_used = 0;
+}
+
+// Flag an allocation made through Playdate API.
+void CountApiAllocation(int bytes)
+{
+   #ifndef NDEBUG
+      if( g_heap_guard && bytes != 0 )
+      {
+         g_heap_stats.guarded_allocations++;
+         LOG_EVENT("memory: Playdate API allocation of %d bytes during game",
+                   bytes);
+      }
+   #else
+      (void)bytes;
+   #endif
+}
+
+// Set heap guard.
+void SetHeapGuard(int enabled)
+{
+   g_heap_guard = enabled;
+}
+
+// Log heap counters.
+void ReportHeap(void)
+{
+   #ifndef NDEBUG
+      LOG_EVENT("memory: heap allocations = %d, reallocations = %d, "
+                "frees = %d, bytes requested = %d, "
+                "live blocks = %d, peak live blocks = %d",
+                g_heap_stats.allocations,
+                g_heap_stats.reallocations,
+                g_heap_stats.frees,
+                g_heap_stats.bytes_requested,
+                g_heap_stats.live_blocks,
+                g_heap_stats.peak_live_blocks);
+      LOG_EVENT("memory: heap allocations during game = %d, "
+                "frame arena peak = %d of %d bytes, overflows = %d",
+                g_heap_stats.guarded_allocations,
+                g_heap_stats.peak_frame_bytes,
+                FRAME_ARENA_SIZE,
+                g_heap_stats.frame_overflows);
+      g_heap_stats.allocations = 0;
+      g_heap_stats.reallocations = 0;
+      g_heap_stats.frees = 0;
+      g_heap_stats.bytes_requested = 0;
+      g_heap_stats.peak_live_blocks = g_heap_stats.live_blocks;
+      g_heap_stats.guarded_allocations = 0;
+      g_heap_stats.peak_frame_bytes = 0;
+      g_heap_stats.frame_overflows = 0;
+   #endif
+}
@@ -0,0 +1,90 @@
+// Library for counting heap allocations.
+//
+// malloc, realloc, and free are routed to Playdate's realloc by the shim in
+// setup.c.  In debug builds, the shim also counts calls here, so that we
+// can see how much the game itself uses the C heap.  Note that memory
+// allocated by Playdate API (bitmaps, fonts, sound players, strings from
+// formatString) doesn't go through the shim and is not counted, except for
+// images created by images.c and world.c, which call CountApiAllocation.
+//
+// Playdate's realloc doesn't tell us block sizes, so we count bytes
+// requested and the number of blocks that are still allocated, but not
+// the number of bytes in use.
+//
+// Code that runs every frame should not allocate from the heap at all,
+// since heap allocations take variable time and fragment the heap.  Short
+// lived buffers can use the frame arena instead, which is a fixed buffer
+// that is reset at the start of every frame.  While the heap guard is set
+// (i.e. while a game is in progress), any allocation that goes through the
+// shim or CountApiAllocation is counted separately and logged in debug
+// builds.
+//
+// This library doesn't depend on Playdate API.
+
+#ifndef HEAP_H_
+#define HEAP_H_
+
+// Size of frame arena in bytes.
+#define FRAME_ARENA_SIZE   4096
+
+typedef struct
+{
+   // Number of calls that allocated a new block (malloc, or realloc with
+   // NULL pointer).
+   int allocations;
+
+   // Number of calls that resized an existing block.
+   int reallocations;
+
+   // Number of calls that freed a block.
+   int frees;
+
+   // Number of blocks allocated but not yet freed, and its maximum value
+   // since the last ReportHeap call.
+   int live_blocks;
+   int peak_live_blocks;
+
+   // Total size requested by allocations and reallocations.
+   int bytes_requested;
+
+   // Number of allocations and reallocations while heap guard was set,
+   // including allocations reported by CountApiAllocation.
+   int guarded_allocations;
+
+   // Maximum number of frame arena bytes used in a single frame, and number
+   // of AllocateFrame calls that failed due to lack of space.
+   int peak_frame_bytes;
+   int frame_overflows;
+} HeapStats;
+
+// Counters updated by setup.c and AllocateFrame.  These are only updated
+// in debug builds.
+extern HeapStats g_heap_stats;
+
+// Nonzero if heap allocations should be flagged.  This is checked by
+// setup.c in debug builds.
+extern int g_heap_guard;
+
+// Allocate memory from the frame arena, aligned to 8 bytes.  Returns NULL
+// if there is not enough space.  Memory is valid until the next
+// ResetFrameArena call, and doesn't need to be freed.
+void *AllocateFrame(int size);
+
+// Release all frame arena allocations.  This is called at the start of
+// every frame.
+void ResetFrameArena(void);
+
+// Flag an allocation made through Playdate API if heap guard is set.
+// These are not seen by the shim in setup.c, so code that creates bitmaps
+// calls this with the size of the new bitmap.  This is a no-op in release
+// builds.
+void CountApiAllocation(int bytes);
+
+// Set heap guard, see g_heap_guard.
+void SetHeapGuard(int enabled);
+
+// Log heap and frame arena counters and reset them, except for
+// live_blocks.  This is a no-op in release builds.
+void ReportHeap(void);
+
+#endif  // HEAP_H_
@@ -0,0 +1,155 @@
+// Play full games with the bot and report what happened.
+//
+// Usage:
+//
+//    ./autoplay.exe [skill] [aggressiveness] [fall_rate] [games] [seed]
+//                   [min_space] [prefix]
+//
+// Defaults are skill=100, aggressiveness=100, fall_rate=0, games=10,
+// seed=1, min_space=80.  Each game uses a consecutive seed starting from
+// {seed}.  See bot.h for the meaning of bot parameters.  If {prefix} is
+// given, inputs for each game are written to "{prefix}{seed}.txt" as a
+// replay (see replay.h).
+//
+// Output is one line per game, followed by a summary line.  Every game
+// plays through the full song, but space platforms are only generated
+// above the cloud platforms that were already generated when the song
+// reached the space phase.  Whether a game reaches space platforms depends
+// on the bot climbing past those in time, which is reported as the lowest
+// platform group that was landed on.
+//
+// Exit status is 1 if fewer than {min_space} percent of games landed on
+// space platforms, so that a regression in the bot or in level generation
+// fails the autoplay target.  Games are deterministic, and with default
+// settings exactly 8 of the 10 seeds land on space platforms, so the
+// default threshold fails if any of those 8 seeds is lost.  The remaining
+// seeds enter the space phase too far below the last cloud platform to
+// climb past it.  Across seeds 1-200, 157 games land on space platforms.  Set
+// {min_space} to 0 when running with settings that deliberately climb
+// slower, such as a nonzero fall_rate.
+
+#include<stdio.h>
+#include<stdlib.h>
+#include"bot.h"
+#include"replay.h"
+#include"simulation.h"
+
+static World g_world;
+static Replay g_replay;
+
+// Statistics for a single game.
+typedef struct
+{
+   // Peak height in pixels.
+   int height;
+
+   // Lowest platform group that the slime has landed on, indexed by
+   // (platform->type / 6), where 0 is space and 3 is trees.
+   int group;
+
+   // Lowest platform group that was generated.  Platforms are generated
+   // just above the visible area, so this is the last group that was
+   // shown on screen.
+   int visible_group;
+
+   // Number of frames played.
+   int frames;
+
+   // Number of springs launches, meteor hits, and longest fall in pixels.
+   int springs;
+   int hits;
+   int max_fall;
+} GameStats;
+
+// Run a single game.
+static void PlayGame(const BotConfig *config, unsigned int seed,
+                     GameStats *stats)
+{
+   Bot bot;
+   ResetBot(&bot, config, seed);
+   ResetSimulation(&g_world, seed);
+   g_replay.seed = seed;
+   g_replay.frame_count = 0;
+
+   stats->group = 3;
+   stats->springs = 0;
+   stats->hits = 0;
+   int frame = 0;
+   for(;; frame++)
+   {
+      const BotInput input = UpdateBot(&bot, &g_world);
+      g_world.slime.events = 0;
+      if( !StepSimulation(&g_world, frame, input.angle, input.jump) )
+         break;
+      g_replay.input[g_replay.frame_count++] = input;
+
+      if( (g_world.slime.events & SLIME_EVENT_SPRING_RELEASE) != 0 )
+         stats->springs++;
+      if( (g_world.slime.events & SLIME_EVENT_HIT) != 0 )
+         stats->hits++;
+      if( (g_world.slime.events & SLIME_EVENT_LAND) != 0 )
+      {
+         const int i = GetRestingPlatform(&g_world);
+         if( i > 0 && stats->group > g_world.platform[i].type / 6 )
+            stats->group = g_world.platform[i].type / 6;
+      }
+   }
+   stats->frames = frame;
+   stats->visible_group =
+      g_world.platform[g_world.platform_limit - 1].type / 6;
+   stats->height = (-g_world.slime.peak) >> SLIME_FRACTION_BITS;
+   stats->max_fall = g_world.slime.max_fall >> SLIME_FRACTION_BITS;
+}
+
+int main(int argc, char **argv)
+{
+   BotConfig config;
+   config.skill = argc > 1 ? atoi(argv[1]) : 100;
+   config.aggressiveness = argc > 2 ? atoi(argv[2]) : 100;
+   config.fall_rate = argc > 3 ? atoi(argv[3]) : 0;
+   const int games = argc > 4 ? atoi(argv[4]) : 10;
+   const unsigned int first_seed = argc > 5 ? (unsigned int)atoi(argv[5]) : 1;
+   const int min_space = argc > 6 ? atoi(argv[6]) : 80;
+   if( games <= 0 )
+   {
+      fprintf(stderr,
+              "%s [skill] [aggressiveness] [fall_rate] [games] [seed] "
+              "[min_space] [prefix]\n",
+              *argv);
+      return 1;
+   }
+
+   int landed_in_space = 0;
+   int64_t total_height = 0;
+   for(int i = 0; i < games; i++)
+   {
+      GameStats stats;
+      PlayGame(&config, first_seed + i, &stats);
+      printf("seed %u: height %d, group %d, visible group %d, frames %d, "
+             "springs %d, hits %d, max fall %d\n",
+             first_seed + i, stats.height, stats.group, stats.visible_group,
+             stats.frames, stats.springs, stats.hits, stats.max_fall);
+      if( argc > 7 )
+      {
+         char path[256];
+         snprintf(path, sizeof(path), "%s%u.txt", argv[7], first_seed + i);
+         if( SaveReplay(path, &g_replay) != 0 )
+         {
+            fprintf(stderr, "Error writing %s\n", path);
+            return 1;
+         }
+      }
+      if( stats.group == 0 )
+         landed_in_space++;
+      total_height += stats.height;
+   }
+   printf("%d/%d games landed on space platforms, average height %d\n",
+          landed_in_space, games, (int)(total_height / games));
+   if( landed_in_space * 100 < min_space * games )
+   {
+      fprintf(stderr, "Expected at least %d%% of games to land on space "
+                      "platforms\n", min_space);
+      return 1;
+   }
+   return 0;
+}
@@ -0,0 +1,799 @@
+#include"bot.h"
+#include<stdlib.h>
+#include"common.h"
+
+// Range of jump angles to consider, in degrees from straight up.
+#define MAX_JUMP_ANGLE        80
+
+// Number of frames where holding the jump button adds vertical velocity,
+// see JumpSlime.
+#define MAX_HOLD_FRAMES       4
+
+// Maximum number of frames to simulate for each jump.  Jumps that don't
+// land within this time are not considered.
+#define MAX_FLIGHT_FRAMES     150
+
+// Vertical range of platforms to consider, relative to slime position.
+#define SEARCH_RANGE          (2 * SCREEN_HEIGHT)
+
+// Maximum number of platforms to consider.
+#define MAX_WINDOW_SIZE       128
+
+// Maximum number of frames to wait when no jump would gain height, and
+// how far ahead to look for moving platforms coming within reach, see
+// FindJumpDelay.
+#define MAX_WAIT_FRAMES       30
+#define MAX_JUMP_DELAY        240
+#define JUMP_DELAY_STEP       8
+
+// Limits for searching multiple jump sequences, see SearchPath.  Angle step
+// applies to jumps after the first one.
+#define MAX_SEARCH_DEPTH      4
+#define MAX_SEARCH_NODES      64
+#define SEARCH_ANGLE_STEP     5
+
+// Maximum number of consecutive jumps from the same height.  SearchPath
+// may keep repositioning back and forth along a platform when the jumps it
+// found don't work out, so after this many hops the platform is treated
+// as a dead end, see IsLooping.
+#define MAX_HOPS              4
+
+// Landing positions within this horizontal distance are considered
+// equivalent when searching for multiple jump sequences.
+#define LANDING_TOLERANCE     8
+
+// Number of frames to look ahead for meteors that would hit a resting
+// slime.  If any meteor would hit within this time, the bot jumps right
+// away instead of waiting.
+#define MAX_DODGE_FRAMES      45
+
+// Extra gain for jumps that bounce off a spring, at maximum aggressiveness.
+#define MAX_SPRING_BONUS      64
+
+// Offset from bottom of slime to center of slime, and spring launch
+// velocity, same as world.c.
+#define SLIME_CENTER_OFFSET   9
+#define SPRING_VELOCITY       (-(20 << SLIME_FRACTION_BITS))
+
+// Gain value for jumps that didn't land.
+#define NO_LANDING            (-0x10000)
+
+// A platform or spring near the slime.
+typedef struct
+{
+   int x, y, width;
+   uint16_t vx;
+} Target;
+
+// Nearby platforms and springs.  Platforms are sorted by elevation from
+// highest to lowest.
+typedef struct
+{
+   Target platform[MAX_WINDOW_SIZE];
+   int platform_count;
+   Target spring[MAX_WINDOW_SIZE];
+   int spring_count;
+} Window;
+
+// A simulated jump.
+typedef struct
+{
+   // Crank angle while the jump button is held, and crank angle for the
+   // rest of the flight.  Vertical velocity only depends on the first one,
+   // so taking off straight up and then turning the crank reaches higher
+   // platforms that are further to the side than a single angle would.
+   unsigned int takeoff_angle;
+   unsigned int angle;
+   int hold;
+
+   // Height gained in pixels, including spring bonus.
+   int gain;
+
+   // 1 if jump bounces off a spring before landing.
+   int spring;
+
+   // Landing position, and number of frames until slime can jump again
+   // after landing.
+   int x, y, t;
+} Candidate;
+
+// Generate a random integer in the range of [0..max].
+static int BotRandom(Bot *bot, int max)
+{
+   // xorshift32.
+   uint32_t x = bot->random_state;
+   x ^= x << 13;
+   x ^= x >> 17;
+   x ^= x << 5;
+   bot->random_state = x;
+   return (int)(x % (uint32_t)(max + 1));
+}
+
+// Get horizontal position of a target after some number of world updates.
+static int GetTargetX(const Target *target, int t)
+{
+   return (int)((target->x + (uint32_t)target->vx * t) % SCREEN_WIDTH);
+}
+
+// Collect platforms and springs within SEARCH_RANGE of slime.
+static void BuildWindow(const World *world, Window *window)
+{
+   const int slime_y = world->slime.y >> SLIME_FRACTION_BITS;
+   int lo = world->platform_cursor;
+   while( lo > 0 && world->platform[lo - 1].y <= slime_y + SEARCH_RANGE )
+      lo--;
+
+   window->platform_count = 0;
+   window->spring_count = 0;
+   for(int i = lo; i < world->platform_limit; i++)
+   {
+      const Platform *p = &(world->platform[i]);
+      if( p->y < slime_y - SEARCH_RANGE ||
+          window->platform_count == MAX_WINDOW_SIZE )
+      {
+         break;
+      }
+
+      // Window is filled from lowest to highest, and then reversed below.
+      Target *t = &(window->platform[window->platform_count++]);
+      t->x = p->x;
+      t->y = p->y;
+      t->width = GetPlatformWidth(p->type);
+      t->vx = p->vx;
+
+      // Springs move with the platform they are attached to.
+      if( p->spring_index >= 0 )
+      {
+         t = &(window->spring[window->spring_count++]);
+         t->x = world->spring[p->spring_index].x;
+         t->y = world->spring[p->spring_index].y;
+         t->width = 0;
+         t->vx = p->vx;
+      }
+   }
+
+   // Reverse so that platforms are checked from highest to lowest, same
+   // order as MoveSlime.
+   for(int i = 0, j = window->platform_count - 1; i < j; i++, j--)
+   {
+      const Target tmp = window->platform[i];
+      window->platform[i] = window->platform[j];
+      window->platform[j] = tmp;
+   }
+}
+
+// Check if any meteor would hit the slime at the start of a world update.
+// This follows the same order as AnimateMeteors, where meteors are moved
+// before checking for collisions.
+static int IsHitByMeteor(const World *world, const Slime *ghost, int t)
+{
+   const int x = ghost->x >> SLIME_FRACTION_BITS;
+   const int y = (ghost->y >> SLIME_FRACTION_BITS) - SLIME_CENTER_OFFSET;
+   for(int i = world->meteor_start; i < world->meteor_end; i++)
+   {
+      const Meteor *meteor = &(world->meteor[i]);
+      if( meteor->hit == 0 &&
+          abs(meteor->x + meteor->vx * t - x) < 16 &&
+          abs(meteor->y + meteor->vy * t - y) < 16 )
+      {
+         return 1;
+      }
+   }
+   return 0;
+}
+
+// Check if a resting slime would be hit by a meteor soon.
+static int IsThreatened(const World *world)
+{
+   for(int t = 1; t <= MAX_DODGE_FRAMES; t++)
+   {
+      if( IsHitByMeteor(world, &(world->slime), t) )
+         return 1;
+   }
+   return 0;
+}
+
+// Check if slime can land at a particular height and jump again before
+// getting hit by a meteor.  Slime can't jump until its landing animation
+// has finished (see JumpSlime).
+static int IsSafeLanding(const World *world, const Slime *ghost, int y, int t)
+{
+   Slime landed = *ghost;
+   landed.y = y << SLIME_FRACTION_BITS;
+   for(int i = 1; i <= (int)ghost->frame + 1; i++)
+   {
+      if( IsHitByMeteor(world, &landed, t + i) )
+         return 0;
+   }
+   return 1;
+}
+
+// Record landing position for a candidate.
+static void SetLanding(const Slime *ghost, int y, int t, int gain,
+                       Candidate *candidate)
+{
+   candidate->gain = gain;
+   candidate->x = ghost->x;
+   candidate->y = y;
+   candidate->t = t + ghost->frame + 1;
+}
+
+// Simulate a jump with a copy of the slime, starting from the slime's
+// state after {t0} world updates.  This follows the same order of updates
+// as UpdateWorld, where meteors and platforms are moved before the slime.
+// Jumps that would be hit by a meteor, either in flight or shortly after
+// landing, are treated as not landing.
+static void SimulateJump(const World *world, const Window *window,
+                         const Slime *start, int t0, int spring_bonus,
+                         Candidate *candidate)
+{
+   Slime ghost = *start;
+   const int start_y = ghost.y >> SLIME_FRACTION_BITS;
+   candidate->gain = NO_LANDING;
+   candidate->spring = 0;
+
+   // Index into window->platform, where all platforms before this index
+   // are above the slime.
+   int p = 0;
+
+   // Compression state of the spring that the slime is touching.
+   int spring_frame = 0;
+
+   for(int t = t0 + 1; t <= t0 + MAX_FLIGHT_FRAMES; t++)
+   {
+      if( t - t0 <= candidate->hold )
+      {
+         ghost.a = candidate->takeoff_angle;
+         JumpSlime(&ghost);
+      }
+      else
+      {
+         ghost.a = candidate->angle;
+      }
+      if( IsHitByMeteor(world, &ghost, t) )
+         return;
+      const int old_y = ghost.y >> SLIME_FRACTION_BITS;
+      UpdateSlime(&ghost);
+      const int new_y = ghost.y >> SLIME_FRACTION_BITS;
+      if( ghost.in_flight_time == 0 )
+      {
+         // Landed on the floor.
+         if( IsSafeLanding(world, &ghost, new_y, t) )
+         {
+            SetLanding(&ghost, new_y, t,
+                       start_y - new_y + spring_bonus * candidate->spring,
+                       candidate);
+         }
+         return;
+      }
+      if( new_y <= old_y )
+         continue;
+
+      // Springs compress for two frames and then launch the slime, same as
+      // MoveSlime.  Springs are spread apart so that the slime touches at
+      // most one of them at a time, which means a single compression
+      // counter is enough.
+      const int x = ghost.x >> SLIME_FRACTION_BITS;
+      int touching_spring = 0;
+      for(int i = 0; i < window->spring_count; i++)
+      {
+         const Target *s = &(window->spring[i]);
+         if( s->y < new_y || s->y > new_y + 24 )
+            continue;
+         const int d = abs(GetTargetX(s, t) - x);
+         if( d > 16 && d < SCREEN_WIDTH - 16 )
+            continue;
+
+         touching_spring = 1;
+         if( spring_frame < 2 )
+         {
+            ghost.vy = s->y - new_y > 12 ? 1 << SLIME_FRACTION_BITS
+                                         : 1 << (SLIME_FRACTION_BITS - 3);
+            spring_frame++;
+         }
+         else
+         {
+            ghost.vy = SPRING_VELOCITY;
+            spring_frame = 0;
+            candidate->spring = 1;
+         }
+      }
+      if( !touching_spring )
+         spring_frame = 0;
+
+      // Platform at exactly the previous height is skipped, same as
+      // MoveSlime.  This allows jumping downward from the starting platform.
+      while( p < window->platform_count && window->platform[p].y < old_y )
+         p++;
+      for(int i = p; i < window->platform_count; i++)
+      {
+         const Target *platform = &(window->platform[i]);
+         if( platform->y > new_y )
+            break;
+         if( i == p && platform->y == old_y )
+            continue;
+         const int x0 = GetTargetX(platform, t);
+         const int x1 = (x0 + platform->width) % SCREEN_WIDTH;
+         if( CollideSlime(&ghost, x0, x1) )
+         {
+            if( IsSafeLanding(world, &ghost, platform->y, t) )
+            {
+               SetLanding(&ghost, platform->y, t,
+                          start_y - platform->y +
+                             spring_bonus * candidate->spring,
+                          candidate);
+            }
+            return;
+         }
+      }
+   }
+}
+
+// Get height gained per frame for a candidate, in 1/256 pixels.
+static int GetClimbRate(const Candidate *candidate)
+{
+   return candidate->gain * 256 / candidate->t;
+}
+
+// Find the number of frames to wait until a jump would gain height, taking
+// into account that a resting slime moves along with its platform.
+// Returns 0 if waiting wouldn't help.
+static int FindJumpDelay(const World *world, const Window *window,
+                         int spring_bonus)
+{
+   // Find horizontal velocity of the platform under the slime.
+   const int y = world->slime.y >> SLIME_FRACTION_BITS;
+   uint16_t vx = 0;
+   for(int i = 0; i < window->platform_count; i++)
+   {
+      const Target *platform = &(window->platform[i]);
+      if( platform->y == y &&
+          CollideSlime(&(world->slime), platform->x,
+                       (platform->x + platform->width) % SCREEN_WIDTH) )
+      {
+         vx = platform->vx;
+         break;
+      }
+   }
+
+   for(int d = JUMP_DELAY_STEP; d <= MAX_JUMP_DELAY; d += JUMP_DELAY_STEP)
+   {
+      Slime start = world->slime;
+      start.x = (int)((start.x + ((uint32_t)vx << SLIME_FRACTION_BITS) * d) %
+                      (SCREEN_WIDTH << SLIME_FRACTION_BITS));
+      for(int a = -MAX_JUMP_ANGLE; a <= MAX_JUMP_ANGLE; a += SEARCH_ANGLE_STEP)
+      {
+         for(int hold = 1; hold <= MAX_HOLD_FRAMES; hold += MAX_HOLD_FRAMES - 1)
+         {
+            Candidate c;
+            c.angle = (unsigned int)(a + 360) % 360;
+            c.takeoff_angle = c.angle;
+            c.hold = hold;
+            SimulateJump(world, window, &start, d, spring_bonus, &c);
+            if( c.gain > 0 )
+               return d;
+         }
+      }
+   }
+   return 0;
+}
+
+// Check if a platform height has been marked as a dead end.
+static int IsDeadEnd(const Bot *bot, int y)
+{
+   for(int i = 0; i < MAX_DEAD_ENDS; i++)
+   {
+      if( bot->dead_end[i] == y )
+         return 1;
+   }
+   return 0;
+}
+
+// Mark a platform height as a dead end.
+static void AddDeadEnd(Bot *bot, int y)
+{
+   bot->dead_end[bot->dead_end_index] = y;
+   bot->dead_end_index = (bot->dead_end_index + 1) % MAX_DEAD_ENDS;
+}
+
+// Check if the bot keeps coming back to the same platform, i.e. it has
+// left this height at least twice recently.  Consecutive jumps from the
+// same height are recorded once, so that hopping along a platform doesn't
+// count, unless the bot has been hopping for too long without leaving.
+static int IsLooping(const Bot *bot, int y)
+{
+   const int last = (bot->recent_jump_index + MAX_RECENT_JUMPS - 1) %
+                    MAX_RECENT_JUMPS;
+   if( bot->recent_jump[last] == y && bot->hops >= MAX_HOPS )
+      return 1;
+
+   int visits = 0;
+   for(int i = 0; i < MAX_RECENT_JUMPS; i++)
+   {
+      if( bot->recent_jump[i] == y )
+         visits++;
+   }
+   return visits >= 2;
+}
+
+// A landing spot visited by SearchPath.
+typedef struct
+{
+   // Landing position and time, same as Candidate.
+   int x, y, t;
+
+   // Index of the first jump that leads to this spot.
+   int first;
+
+   // Number of jumps needed to get here.
+   int depth;
+} SearchNode;
+
+// Add a search node for a landing spot, unless there is already a node
+// nearby.  Returns 1 if node was added.
+static int AddSearchNode(SearchNode *node, int *node_count,
+                         const Candidate *landing, int first, int depth)
+{
+   if( *node_count == MAX_SEARCH_NODES )
+      return 0;
+   for(int i = 0; i < *node_count; i++)
+   {
+      if( node[i].y == landing->y &&
+          abs(node[i].x - landing->x) <
+             (LANDING_TOLERANCE << SLIME_FRACTION_BITS) )
+      {
+         return 0;
+      }
+   }
+   SearchNode *n = &(node[(*node_count)++]);
+   n->x = landing->x;
+   n->y = landing->y;
+   n->t = landing->t;
+   n->first = first;
+   n->depth = depth;
+   return 1;
+}
+
+// Search for a sequence of jumps that eventually gains height, and return
+// the first jump of the sequence that gains the most height, or NULL if
+// there are none.  This is used when no single jump gains height, such as
+// when the next platform is only reachable from the far end of the current
+// platform, or when the way up requires going down first.
+//
+// This is a breadth first search over landing spots, where spots at the
+// same height and nearby positions are merged.  Later jumps are evaluated
+// at coarser angles and always take off straight up, and platform movement
+// while resting is not modeled, so a sequence found here is only a hint.  The bot plans again after
+// each landing.
+static const Candidate *SearchPath(Bot *bot, const World *world,
+                                   const Window *window, int spring_bonus,
+                                   const Candidate *candidate, int count)
+{
+   // Multiple jump sequences are only found by skilled bots.
+   if( bot->config.skill < 50 )
+      return NULL;
+
+   SearchNode node[MAX_SEARCH_NODES];
+   int node_count = 0;
+   for(int i = 0; i < count; i++)
+      AddSearchNode(node, &node_count, &(candidate[i]), i, 1);
+
+   const int start_y = world->slime.y >> SLIME_FRACTION_BITS;
+   const Candidate *selected = NULL;
+   int best_gain = 0;
+   int found_depth = MAX_SEARCH_DEPTH;
+   for(int i = 0; i < node_count && node[i].depth < found_depth; i++)
+   {
+      Slime start = world->slime;
+      start.x = node[i].x;
+      start.y = node[i].y << SLIME_FRACTION_BITS;
+      start.vx = 0;
+      start.vy = 0;
+      start.in_flight_time = 0;
+      start.frame = 0;
+      start.stun = 0;
+
+      for(int a = -MAX_JUMP_ANGLE; a <= MAX_JUMP_ANGLE; a += SEARCH_ANGLE_STEP)
+      {
+         for(int hold = 1; hold <= MAX_HOLD_FRAMES; hold += MAX_HOLD_FRAMES - 1)
+         {
+            Candidate next;
+            next.angle = (unsigned int)(a + 360) % 360;
+            next.takeoff_angle = 0;
+            next.hold = hold;
+            SimulateJump(world, window, &start, node[i].t, spring_bonus,
+                         &next);
+            if( next.gain == NO_LANDING || IsDeadEnd(bot, next.y) )
+               continue;
+
+            // Stop at the first depth where any sequence gains height, and
+            // select the sequence that gains the most.
+            const int gain = next.gain + start_y - node[i].y;
+            if( gain > 0 )
+            {
+               found_depth = node[i].depth;
+               if( best_gain < gain )
+               {
+                  best_gain = gain;
+                  selected = &(candidate[node[i].first]);
+               }
+            }
+            else if( found_depth == MAX_SEARCH_DEPTH )
+            {
+               AddSearchNode(node, &node_count, &next, node[i].first,
+                             node[i].depth + 1);
+            }
+         }
+      }
+   }
+   return selected;
+}
+
+// Select a jump.  Returns 1 if a jump was selected, 0 to wait.
+static int PlanJump(Bot *bot, const World *world)
+{
+   Window window;
+   BuildWindow(world, &window);
+
+   const int skill = bot->config.skill;
+   const int angle_step = 2 + (100 - skill) / 10;
+   const int min_hold = skill >= 50 ? 1 : MAX_HOLD_FRAMES;
+   const int spring_bonus = MAX_SPRING_BONUS * bot->config.aggressiveness / 100;
+
+   // Break out of loops by avoiding the current platform from now on.
+   // This happens when the bot keeps selecting a small gain that leads
+   // nowhere, such as a hop onto a neighboring platform, instead of a
+   // spring or a longer detour.
+   const int start_y = world->slime.y >> SLIME_FRACTION_BITS;
+   if( bot->wait == 0 && start_y < 0 &&
+       !IsDeadEnd(bot, start_y) && IsLooping(bot, start_y) )
+      AddDeadEnd(bot, start_y);
+
+   // Skilled bots also consider taking off straight up and turning the
+   // crank after releasing the button, which is often the only way to
+   // reach a platform that is both high above and off to the side.
+   const int max_takeoff = skill >= 50 ? 2 : 1;
+
+   Candidate candidate[(2 * MAX_JUMP_ANGLE + 1) * MAX_HOLD_FRAMES * 2];
+   int count = 0;
+   int min_rate = 0, max_rate = 0;
+   int lowest = -1, highest = -1;
+   for(int a = -MAX_JUMP_ANGLE; a <= MAX_JUMP_ANGLE; a += angle_step)
+   {
+      const int takeoff_count = a != 0 ? max_takeoff : 1;
+      for(int hold = min_hold; hold <= MAX_HOLD_FRAMES; hold++)
+      {
+         for(int takeoff = 0; takeoff < takeoff_count; takeoff++)
+         {
+            Candidate *c = &(candidate[count]);
+            c->angle = (unsigned int)(a + 360) % 360;
+            c->takeoff_angle = takeoff == 0 ? c->angle : 0;
+            c->hold = hold;
+            SimulateJump(world, &window, &(world->slime), 0, spring_bonus, c);
+            if( c->gain == NO_LANDING || IsDeadEnd(bot, c->y) )
+               continue;
+            if( c->gain > 0 )
+            {
+               const int rate = GetClimbRate(c);
+               if( min_rate == 0 || min_rate > rate )
+                  min_rate = rate;
+               if( max_rate < rate )
+                  max_rate = rate;
+            }
+            if( lowest < 0 || candidate[lowest].gain > c->gain )
+               lowest = count;
+            if( highest < 0 || candidate[highest].gain < c->gain )
+               highest = count;
+            count++;
+         }
+      }
+   }
+   if( count == 0 )
+      return 0;
+
+   const int threatened = IsThreatened(world);
+   const Candidate *selected;
+   if( world->slime.y < 0 &&
+       candidate[lowest].gain < 0 &&
+       BotRandom(bot, 99) < bot->config.fall_rate )
+   {
+      // Deliberately drop down.
+      selected = &(candidate[lowest]);
+   }
+   else if( max_rate > 0 )
+   {
+      // Select the jump with climb rate closest to target, breaking ties
+      // at random so that the bot doesn't favor one side.
+      const int target =
+         min_rate + (max_rate - min_rate) * bot->config.aggressiveness / 100;
+      int best_distance = 0, ties = 0;
+      selected = NULL;
+      for(int i = 0; i < count; i++)
+      {
+         if( candidate[i].gain <= 0 )
+            continue;
+         const int distance = abs(GetClimbRate(&(candidate[i])) - target);
+         if( selected == NULL || best_distance > distance )
+         {
+            selected = &(candidate[i]);
+            best_distance = distance;
+            ties = 1;
+         }
+         else if( best_distance == distance && BotRandom(bot, ties++) == 0 )
+         {
+            selected = &(candidate[i]);
+         }
+      }
+      assert(selected != NULL);
+   }
+   else if( (selected = SearchPath(bot, world, &window, spring_bonus,
+                                   candidate, count)) != NULL )
+   {
+      // Reposition for a jump that gains height.
+   }
+   else if( bot->wait < MAX_WAIT_FRAMES && !threatened )
+   {
+      // Nothing gains height right now, but a moving platform might come
+      // within reach if we wait a bit.
+      bot->wait++;
+      if( bot->wait == MAX_WAIT_FRAMES )
+      {
+         const int d = FindJumpDelay(world, &window, spring_bonus);
+         if( d > 0 )
+         {
+            // Check again a bit before the predicted time.
+            bot->delay = d - JUMP_DELAY_STEP;
+            bot->wait = 0;
+         }
+      }
+      return 0;
+   }
+   else
+   {
+      // Waited long enough, so this platform is likely a dead end.  Avoid
+      // it from now on, and take the highest jump that goes somewhere else.
+      AddDeadEnd(bot, start_y);
+      selected = &(candidate[highest]);
+      for(int i = 0; i < count; i++)
+      {
+         if( candidate[i].y != start_y &&
+             (selected->y == start_y || selected->gain < candidate[i].gain) )
+         {
+            selected = &(candidate[i]);
+         }
+      }
+   }
+
+   // Apply aiming error.
+   const int error = (100 - skill) / 4;
+   const int e = BotRandom(bot, 2 * error) - error;
+   bot->angle = (selected->angle + 360 + e) % 360;
+   bot->takeoff_angle = (selected->takeoff_angle + 360 + e) % 360;
+   bot->hold = selected->hold;
+   bot->target_y = selected->y;
+   bot->delay = (100 - skill) / 20;
+   bot->wait = 0;
+   const int last = (bot->recent_jump_index + MAX_RECENT_JUMPS - 1) %
+                    MAX_RECENT_JUMPS;
+   if( bot->recent_jump[last] == start_y )
+   {
+      bot->hops++;
+   }
+   else
+   {
+      bot->hops = 0;
+      bot->recent_jump[bot->recent_jump_index] = start_y;
+      bot->recent_jump_index = (bot->recent_jump_index + 1) % MAX_RECENT_JUMPS;
+   }
+   bot->jumps++;
+   bot->spring_jumps += selected->spring;
+   return 1;
+}
+
+// Adjust crank angle while in flight, if the current angle would no longer
+// land at the planned height.  This recovers from aiming errors and
+// meteor hits, and dodges meteors that spawned after the jump.
+static void SteerBot(Bot *bot, const World *world)
+{
+   Window window;
+   BuildWindow(world, &window);
+   const int spring_bonus =
+      MAX_SPRING_BONUS * bot->config.aggressiveness / 100;
+
+   Candidate current;
+   current.angle = bot->angle;
+   current.takeoff_angle = bot->angle;
+   current.hold = 0;
+   SimulateJump(world, &window, &(world->slime), 0, spring_bonus, &current);
+   if( current.gain != NO_LANDING && current.y <= bot->target_y )
+      return;
+
+   // Select the angle that lands at the highest elevation.
+   const int angle_step = 2 + (100 - bot->config.skill) / 10;
+   int best_gain = current.gain;
+   for(int a = -MAX_JUMP_ANGLE; a <= MAX_JUMP_ANGLE; a += angle_step)
+   {
+      Candidate c;
+      c.angle = (unsigned int)(a + 360) % 360;
+      c.takeoff_angle = c.angle;
+      c.hold = 0;
+      SimulateJump(world, &window, &(world->slime), 0, spring_bonus, &c);
+      if( best_gain < c.gain )
+      {
+         best_gain = c.gain;
+         bot->angle = c.angle;
+      }
+   }
+}
+
+// Initialize bot.
+void ResetBot(Bot *bot, const BotConfig *config, uint32_t seed)
+{
+   bot->config = *config;
+   bot->random_state = seed != 0 ? seed : 1;
+   bot->angle = 0;
+   bot->takeoff_angle = 0;
+   bot->hold = 0;
+   bot->target_y = 0;
+   bot->delay = 0;
+   bot->wait = 0;
+   bot->jumps = 0;
+   bot->spring_jumps = 0;
+
+   // Platforms are never below the floor, so positive values mark unused
+   // entries.
+   for(int i = 0; i < MAX_DEAD_ENDS; i++)
+      bot->dead_end[i] = 1;
+   bot->dead_end_index = 0;
+   for(int i = 0; i < MAX_RECENT_JUMPS; i++)
+      bot->recent_jump[i] = 1;
+   bot->recent_jump_index = 0;
+   bot->hops = 0;
+}
+
+// Get inputs for next frame.
+BotInput UpdateBot(Bot *bot, const World *world)
+{
+   BotInput input;
+   input.angle = bot->angle;
+   input.jump = 0;
+
+   // Continue holding jump button for the selected duration.
+   if( bot->hold > 0 )
+   {
+      bot->hold--;
+      input.angle = bot->takeoff_angle;
+      input.jump = 1;
+      return input;
+   }
+
+   // Steer while in flight, and wait for slime to settle after landing.
+   // Input is ignored while stunned, see JumpSlime.
+   const Slime *slime = &(world->slime);
+   if( slime->stun != 0 )
+      return input;
+   if( slime->in_flight_time != 0 )
+   {
+      if( bot->config.skill >= 50 )
+      {
+         SteerBot(bot, world);
+         input.angle = bot->angle;
+      }
+      return input;
+   }
+   if( slime->frame != 0 )
+      return input;
+   if( bot->delay > 0 && !IsThreatened(world) )
+   {
+      bot->delay--;
+      return input;
+   }
+
+   if( PlanJump(bot, world) )
+   {
+      bot->hold--;
+      input.angle = bot->takeoff_angle;
+      input.jump = 1;
+   }
+   return input;
+}
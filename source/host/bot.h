@@ -0,0 +1,116 @@
+// Library for playing the game automatically, for host benchmarks and
+// simulations.
+//
+// The bot reads World state and produces the same inputs as a player: a
+// crank angle and whether the jump button is held.  Callers apply these
+// inputs the same way as main.c, by setting slime.a and calling JumpSlime
+// before each UpdateWorld (see simulation.h).
+//
+// Whenever the slime comes to rest, the bot simulates a range of jump
+// angles and button hold durations with a copy of the slime, checking
+// where each jump would land among the nearby platforms and springs.  It
+// then selects a landing according to its configuration and commits to
+// that jump.  Jumps that cross the path of a meteor already on screen are
+// avoided, but meteors that have not spawned yet are not predicted.
+//
+// The bot has its own random number generator, so that bot decisions
+// don't change the sequence of platforms generated for a given seed.
+
+#ifndef BOT_H_
+#define BOT_H_
+
+#include<stdint.h>
+#include"world.h"
+
+// Number of dead end platforms remembered by the bot.
+#define MAX_DEAD_ENDS   16
+
+// Number of recent jump heights remembered by the bot.
+#define MAX_RECENT_JUMPS   8
+
+typedef struct
+{
+   // Skill level [0..100].  Higher skill evaluates more jump angles and
+   // button hold durations, reacts faster after landing, and has less
+   // aiming error.  At skill 0, the bot only does full height jumps and
+   // misses its target angle by up to 25 degrees.
+   int skill;
+
+   // Aggressiveness [0..100].  Among the reachable landings that gain
+   // height, 0 selects the one with the slowest climb rate (height gained
+   // per frame, including landing animation) and 100 selects the fastest.
+   // Springs count for extra height in proportion to aggressiveness, so
+   // aggressive bots seek out springs on diversions.
+   int aggressiveness;
+
+   // Percentage of jumps [0..100] where the bot deliberately selects the
+   // lowest reachable landing, for exercising long falls.
+   int fall_rate;
+} BotConfig;
+
+// Inputs for a single frame.
+typedef struct
+{
+   // Crank angle [0..359], same as Slime.a.
+   unsigned int angle;
+
+   // 1 if jump button is held.
+   int jump;
+} BotInput;
+
+typedef struct
+{
+   BotConfig config;
+
+   // Random number generator state.
+   uint32_t random_state;
+
+   // Crank angle while holding the jump button, and crank angle for the
+   // rest of the flight.
+   unsigned int takeoff_angle;
+   unsigned int angle;
+
+   // Number of remaining frames to hold the jump button.
+   int hold;
+
+   // Planned landing height, in pixels.
+   int target_y;
+
+   // Number of frames to wait before planning the next jump.
+   int delay;
+
+   // Number of consecutive frames spent waiting for a better jump, used
+   // when no jump would gain height (e.g. while on a moving platform).
+   int wait;
+
+   // Heights of platforms where the bot got stuck, stored in a circular
+   // buffer.  The bot avoids landing on these platforms so that it can
+   // find a different way up.
+   int dead_end[MAX_DEAD_ENDS];
+   int dead_end_index;
+
+   // Heights of the platforms where recent jumps started, stored in a
+   // circular buffer with consecutive duplicates removed.  Repeatedly
+   // jumping from the same platform means the bot is going back and forth
+   // between platforms without gaining height, so that platform is marked
+   // as a dead end.
+   int recent_jump[MAX_RECENT_JUMPS];
+   int recent_jump_index;
+
+   // Number of consecutive jumps from the same height, i.e. the number of
+   // consecutive duplicates removed from recent_jump.
+   int hops;
+
+   // Statistics: number of jumps started, and number of those jumps that
+   // were aimed at a spring.
+   int jumps;
+   int spring_jumps;
+} Bot;
+
+// Initialize bot.
+void ResetBot(Bot *bot, const BotConfig *config, uint32_t seed);
+
+// Get inputs for the next world update.
+BotInput UpdateBot(Bot *bot, const World *world);
+
+#endif  // BOT_H_
@@ -0,0 +1,90 @@
+// Count function calls for profile-guided function ordering.
+//
+// For "make link_order", game sources are compiled with
+// -finstrument-functions, which makes every function entry (including
+// inlined ones) call __cyg_profile_func_enter.  This file counts those
+// calls by function address, and at exit, writes one line per function to
+// the file named by CALL_PROFILE environment variable:
+//
+//    {offset} {calls}
+//
+// where offset is the function address relative to the address of
+// __cyg_profile_func_enter, so that the output can be matched against nm
+// output regardless of where the executable was loaded.  See
+// generate_link_order.pl for how these are used.
+//
+// This file must be compiled without -finstrument-functions.
+
+#include<stdint.h>
+#include<stdio.h>
+#include<stdlib.h>
+
+// Hash table size.  This must be a power of 2, and larger than the number
+// of instrumented functions.
+#define TABLE_SIZE   4096
+
+typedef struct
+{
+   void *function;
+   uint64_t calls;
+} CallCount;
+
+static CallCount g_table[TABLE_SIZE];
+
+void __cyg_profile_func_enter(void *function, void *call_site);
+void __cyg_profile_func_exit(void *function, void *call_site);
+
+// Count one call.
+void __cyg_profile_func_enter(void *function, void *call_site)
+{
+   (void)call_site;
+   unsigned int i = (unsigned int)(((uintptr_t)function >> 2) * 2654435761u);
+   for(int probe = 0; probe < TABLE_SIZE; probe++)
+   {
+      CallCount *entry = &g_table[(i + probe) & (TABLE_SIZE - 1)];
+      if( entry->function == function )
+      {
+         entry->calls++;
+         return;
+      }
+      if( entry->function == NULL )
+      {
+         entry->function = function;
+         entry->calls = 1;
+         return;
+      }
+   }
+   fputs("call_profile: too many functions\n", stderr);
+   abort();
+}
+
+void __cyg_profile_func_exit(void *function, void *call_site)
+{
+   (void)function;
+   (void)call_site;
+}
+
+// Write counts at exit.
+__attribute__((destructor)) static void WriteCallProfile(void)
+{
+   const char *path = getenv("CALL_PROFILE");
+   if( path == NULL )
+      return;
+   FILE *outfile = fopen(path, "wb");
+   if( outfile == NULL )
+   {
+      fprintf(stderr, "Error writing %s\n", path);
+      return;
+   }
+   const intptr_t base = (intptr_t)__cyg_profile_func_enter;
+   for(int i = 0; i < TABLE_SIZE; i++)
+   {
+      if( g_table[i].function == NULL )
+         continue;
+      fprintf(outfile, "%lld %llu\n",
+              (long long)((intptr_t)g_table[i].function - base),
+              (unsigned long long)g_table[i].calls);
+   }
+   if( fclose(outfile) != 0 )
+      fprintf(stderr, "Error writing %s\n", path);
+}
@@ -0,0 +1,139 @@
+// Count work done by world updates and drawing over a set of replays.
+//
+// Usage:
+//
+//    ./cost_model.exe {replay.txt...}
+//
+// Each replay is played back with StepSimulation and DrawWorld, and work
+// counters (see work_count.h) are collected for every frame.  Output has
+// the total and per-frame maximum of each counter for each replay and for
+// all replays combined, along with a bit of world state at the end of each
+// game to show that the replay played out the same way.
+//
+// Unlike timings, counts don't depend on the machine or on system load,
+// so "make cost_model" can be run before and after a change, and the two
+// reports diffed to see whether the change made the common paths cheaper.
+// Counts only go up or down for changes in game code, or changes in the
+// replay corpus under host/replays.
+
+#include<stdio.h>
+#include<stdlib.h>
+#include"host_api.h"
+#include"hud.h"
+#include"images.h"
+#include"replay.h"
+#include"simulation.h"
+#include"slime.h"
+#include"work_count.h"
+
+// Number of frames to look ahead for loading images, same as
+// PHASE_LOOK_AHEAD in bgm.c.
+#define LOOK_AHEAD_FRAMES  (2 * SIMULATION_RATE)
+
+// Accumulated counts.
+typedef struct
+{
+   int frames;
+   uint64_t total[kWorkCounterCount];
+   uint32_t max[kWorkCounterCount];
+} CostSummary;
+
+static World g_world;
+static Replay g_replay;
+
+// Add counts for a single frame to summary.
+static void AddFrameCost(CostSummary *summary)
+{
+   summary->frames++;
+   for(int i = 0; i < kWorkCounterCount; i++)
+   {
+      summary->total[i] += g_work_count[i];
+      if( summary->max[i] < g_work_count[i] )
+         summary->max[i] = g_work_count[i];
+   }
+}
+
+// Merge summary for one replay into the overall summary.
+static void MergeCost(CostSummary *all, const CostSummary *one)
+{
+   all->frames += one->frames;
+   for(int i = 0; i < kWorkCounterCount; i++)
+   {
+      all->total[i] += one->total[i];
+      if( all->max[i] < one->max[i] )
+         all->max[i] = one->max[i];
+   }
+}
+
+// Print summary.
+static void PrintCost(const char *label, const CostSummary *summary)
+{
+   printf("%s: frames %d\n", label, summary->frames);
+   for(int i = 0; i < kWorkCounterCount; i++)
+   {
+      printf("   %s: total %llu, max %u\n",
+             GetWorkCounterName((WorkCounter)i),
+             (unsigned long long)summary->total[i],
+             summary->max[i]);
+   }
+}
+
+// Play a replay, drawing every frame.
+static void PlayReplay(const Replay *replay, PlaydateAPI *pd,
+                       CostSummary *summary)
+{
+   ResetSimulation(&g_world, replay->seed);
+   for(int frame = 0;; frame++)
+   {
+      int upcoming_phase = GetSimulationPhase(frame + LOOK_AHEAD_FRAMES);
+      if( upcoming_phase > kPlatformSpace )
+         upcoming_phase = kPlatformSpace;
+      UpdateWorldImages(&g_world, (PlatformStyle)upcoming_phase, pd);
+
+      const BotInput input = GetReplayInput(replay, frame);
+      ResetWorkCount();
+      if( !StepSimulation(&g_world, frame, input.angle, input.jump) )
+         break;
+      DrawWorld(&g_world, pd);
+      AddFrameCost(summary);
+   }
+}
+
+int main(int argc, char **argv)
+{
+   if( argc < 2 )
+   {
+      fprintf(stderr, "%s {replay.txt...}\n", *argv);
+      return 1;
+   }
+
+   PlaydateAPI *pd = InitHostAPI("images");
+   const char *error;
+   LoadHud(pd, pd->graphics->loadFont("", &error));
+   OpenImages(pd);
+   LoadSlime(pd);
+   LoadWorld(pd);
+   while( !LoadPendingWorldImages(pd) )
+      ;
+
+   CostSummary all = {0};
+   for(int i = 1; i < argc; i++)
+   {
+      if( LoadReplay(argv[i], &g_replay) != 0 )
+      {
+         fprintf(stderr, "Error reading %s\n", argv[i]);
+         return 1;
+      }
+      CostSummary one = {0};
+      PlayReplay(&g_replay, pd, &one);
+      PrintCost(argv[i], &one);
+      printf("   end state: platform_limit %d, spring_limit %d, "
+             "height %d, checksum %08x\n",
+             g_world.platform_limit, g_world.spring_limit,
+             (-g_world.slime.peak) >> SLIME_FRACTION_BITS,
+             GetHostFrameChecksum());
+      MergeCost(&all, &one);
+   }
+   PrintCost("all", &all);
+   return 0;
+}
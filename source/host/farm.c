@@ -0,0 +1,379 @@
+// Play many games in parallel, and summarize level generation and frame
+// cost across seeds.
+//
+// Usage:
+//
+//    ./farm.exe [games] [workers] [seed] [replay]
+//
+// Defaults are games=1000, workers=number of online CPUs, seed=1.  Each
+// game uses a consecutive seed starting from {seed}, and is played by the
+// bot with the same settings as autoplay.c.  If a replay file is given
+// (see replay.h), its inputs are applied to every seed instead, and the
+// seed recorded in the replay is ignored.
+//
+// Workers are separate processes rather than threads, because world
+// generation uses the process-wide rand() state.  Each worker owns one
+// World, and takes the next unplayed seed from a shared counter as soon as
+// it finishes a game, so that long games don't hold up other workers.
+// Workers don't share anything else, so throughput should scale with the
+// number of cores.
+//
+// Throughput of "make farm" (1000 games), measured on a machine with only
+// one online CPU, so N=1 and extra workers just take turns on that core:
+//
+//    workers   time      games/s
+//    N (=1)    140.3 s   7.1
+//    1         139.9 s   7.1
+//    2         141.0 s   7.1
+//    4         140.8 s   7.1
+//
+// This shows that extra workers cost almost nothing, but it says nothing
+// about scaling.  Repeat on a multi-core machine before relying on it.
+//
+// Game code is built with assertions enabled.  A failed assertion
+// terminates the worker, which is reported as a violation for the seed it
+// was playing, and the worker is replaced with a new one.
+//
+// Frame cost is the CPU time spent in StepSimulation, measured with the
+// worker's own CPU clock so that it's not affected by scheduling.  These
+// are host timings, only useful for comparing seeds and builds.
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<sys/mman.h>
+#include<sys/wait.h>
+#include<time.h>
+#include<unistd.h>
+#include"bot.h"
+#include"replay.h"
+#include"simulation.h"
+
+// Default number of games.
+#define DEFAULT_GAMES   1000
+
+// Maximum number of worker processes.
+#define MAX_WORKERS     256
+
+// Frame cost histogram has one bucket per COST_BUCKET_SIZE nanoseconds,
+// with the last bucket collecting everything above.
+#define COST_BUCKETS       2000
+#define COST_BUCKET_SIZE   100
+
+// Game status.
+typedef enum
+{
+   kGameNotPlayed,
+   kGameDone,
+   kGameViolation
+} GameStatus;
+
+// Statistics for a single game.
+typedef struct
+{
+   GameStatus status;
+
+   // Final platform_limit, spring_limit, and meteor_end.  Platforms,
+   // springs, and meteor slots are never reused, so these are also the
+   // maximum values.
+   int platforms;
+   int springs;
+   int meteors;
+
+   // Peak height in pixels.
+   int height;
+
+   // Total and maximum frame cost in nanoseconds.
+   int64_t total_cost;
+   int max_cost;
+   int max_cost_frame;
+} GameResult;
+
+// State shared between all processes.
+typedef struct
+{
+   // Index of the next game to be played.
+   int next_game;
+
+   // Index of the game that each worker is playing, or -1 if idle.
+   int current_game[MAX_WORKERS];
+
+   // Frame cost histogram for each worker.
+   uint64_t histogram[MAX_WORKERS][COST_BUCKETS];
+
+   GameResult result[];
+} Farm;
+
+static World g_world;
+
+// Get CPU time used by current thread in nanoseconds.
+static int64_t GetThreadTime(void)
+{
+   struct timespec now;
+   clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+   return (int64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+// Get wall clock time in seconds.
+static double GetWallTime(void)
+{
+   struct timespec now;
+   clock_gettime(CLOCK_MONOTONIC, &now);
+   return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+// Run a single game, using either the bot or a replay for inputs.
+static void PlayGame(unsigned int seed, const Replay *replay,
+                     uint64_t *histogram, GameResult *result)
+{
+   static const BotConfig kConfig = {100, 100, 0};
+   Bot bot;
+   ResetBot(&bot, &kConfig, seed);
+   ResetSimulation(&g_world, seed);
+
+   result->total_cost = 0;
+   result->max_cost = 0;
+   result->max_cost_frame = 0;
+   for(int frame = 0;; frame++)
+   {
+      const BotInput input = replay != NULL ? GetReplayInput(replay, frame)
+                                            : UpdateBot(&bot, &g_world);
+      const int64_t start = GetThreadTime();
+      if( !StepSimulation(&g_world, frame, input.angle, input.jump) )
+         break;
+      const int cost = (int)(GetThreadTime() - start);
+
+      result->total_cost += cost;
+      if( result->max_cost < cost )
+      {
+         result->max_cost = cost;
+         result->max_cost_frame = frame;
+      }
+      const int bucket = cost / COST_BUCKET_SIZE;
+      histogram[bucket < COST_BUCKETS ? bucket : COST_BUCKETS - 1]++;
+   }
+   result->platforms = g_world.platform_limit;
+   result->springs = g_world.spring_limit;
+   result->meteors = g_world.meteor_end;
+   result->height = (-g_world.slime.peak) >> SLIME_FRACTION_BITS;
+   result->status = kGameDone;
+}
+
+// Play games until there are none left.
+static void RunWorker(Farm *farm, int worker, int games,
+                      unsigned int first_seed, const Replay *replay)
+{
+   for(;;)
+   {
+      const int game = __atomic_fetch_add(&(farm->next_game), 1,
+                                          __ATOMIC_RELAXED);
+      if( game >= games )
+         break;
+      farm->current_game[worker] = game;
+      PlayGame(first_seed + game, replay, farm->histogram[worker],
+               &(farm->result[game]));
+      farm->current_game[worker] = -1;
+   }
+}
+
+// Start a worker process.  Returns process ID.
+static pid_t StartWorker(Farm *farm, int worker, int games,
+                         unsigned int first_seed, const Replay *replay)
+{
+   farm->current_game[worker] = -1;
+   fflush(stdout);
+   const pid_t pid = fork();
+   if( pid == 0 )
+   {
+      RunWorker(farm, worker, games, first_seed, replay);
+      _exit(0);
+   }
+   if( pid < 0 )
+   {
+      perror("fork");
+      exit(1);
+   }
+   return pid;
+}
+
+// Print summary of all games.  Returns number of violations.
+static int PrintReport(const Farm *farm, int games, int workers,
+                       unsigned int first_seed, double elapsed)
+{
+   printf("%d games, %d workers, %.1f s, %.1f games/s\n",
+          games, workers, elapsed, games / elapsed);
+
+   int played = 0, violations = 0;
+   int min_platforms = MAX_PLATFORMS, max_platforms = 0, max_platforms_game = 0;
+   int min_springs = MAX_SPRINGS, max_springs = 0, max_springs_game = 0;
+   int min_meteors = MAX_METEORS, max_meteors = 0, max_meteors_game = 0;
+   int min_height = 0x7fffffff, max_height = 0;
+   int64_t total_platforms = 0, total_springs = 0, total_meteors = 0;
+   int64_t total_height = 0;
+   int64_t total_cost = 0, total_frames = 0;
+   int max_cost = 0, max_cost_game = 0;
+   for(int i = 0; i < games; i++)
+   {
+      const GameResult *r = &(farm->result[i]);
+      if( r->status == kGameViolation )
+      {
+         printf("assert violation: seed %u\n", first_seed + i);
+         violations++;
+      }
+      if( r->status != kGameDone )
+         continue;
+
+      played++;
+      total_platforms += r->platforms;
+      if( min_platforms > r->platforms )
+         min_platforms = r->platforms;
+      if( max_platforms < r->platforms )
+      {
+         max_platforms = r->platforms;
+         max_platforms_game = i;
+      }
+      total_springs += r->springs;
+      if( min_springs > r->springs )
+         min_springs = r->springs;
+      if( max_springs < r->springs )
+      {
+         max_springs = r->springs;
+         max_springs_game = i;
+      }
+      total_meteors += r->meteors;
+      if( min_meteors > r->meteors )
+         min_meteors = r->meteors;
+      if( max_meteors < r->meteors )
+      {
+         max_meteors = r->meteors;
+         max_meteors_game = i;
+      }
+      total_height += r->height;
+      if( min_height > r->height )
+         min_height = r->height;
+      if( max_height < r->height )
+         max_height = r->height;
+      total_cost += r->total_cost;
+      if( max_cost < r->max_cost )
+      {
+         max_cost = r->max_cost;
+         max_cost_game = i;
+      }
+   }
+   printf("assert violations: %d\n", violations);
+   if( played == 0 )
+      return violations;
+
+   printf("platforms: min %d, average %d, max %d (seed %u), capacity %d\n",
+          min_platforms, (int)(total_platforms / played), max_platforms,
+          first_seed + max_platforms_game, MAX_PLATFORMS);
+   printf("springs: min %d, average %d, max %d (seed %u), capacity %d\n",
+          min_springs, (int)(total_springs / played), max_springs,
+          first_seed + max_springs_game, MAX_SPRINGS);
+   printf("meteors: min %d, average %d, max %d (seed %u), capacity %d\n",
+          min_meteors, (int)(total_meteors / played), max_meteors,
+          first_seed + max_meteors_game, MAX_METEORS);
+   printf("height: min %d, average %d, max %d\n",
+          min_height, (int)(total_height / played), max_height);
+
+   // Merge histograms to get percentiles.
+   uint64_t histogram[COST_BUCKETS] = {0};
+   for(int w = 0; w < workers; w++)
+   {
+      for(int i = 0; i < COST_BUCKETS; i++)
+         histogram[i] += farm->histogram[w][i];
+   }
+   for(int i = 0; i < COST_BUCKETS; i++)
+      total_frames += histogram[i];
+   int p50 = 0, p99 = 0;
+   uint64_t count = 0;
+   for(int i = 0; i < COST_BUCKETS; i++)
+   {
+      count += histogram[i];
+      if( count * 2 < (uint64_t)total_frames )
+         p50 = i + 1;
+      if( count * 100 < (uint64_t)total_frames * 99 )
+         p99 = i + 1;
+   }
+   printf("frame cost: average %.2f us, p50 %.1f us, p99 %.1f us, "
+          "max %.1f us (seed %u, frame %d)\n",
+          total_cost / 1e3 / total_frames,
+          p50 * COST_BUCKET_SIZE / 1e3, p99 * COST_BUCKET_SIZE / 1e3,
+          max_cost / 1e3,
+          first_seed + max_cost_game,
+          farm->result[max_cost_game].max_cost_frame);
+   return violations;
+}
+
+int main(int argc, char **argv)
+{
+   const int games = argc > 1 ? atoi(argv[1]) : DEFAULT_GAMES;
+   int workers = argc > 2 ? atoi(argv[2]) : (int)sysconf(_SC_NPROCESSORS_ONLN);
+   const unsigned int first_seed = argc > 3 ? (unsigned int)atoi(argv[3]) : 1;
+   if( games <= 0 || workers <= 0 )
+   {
+      fprintf(stderr, "%s [games] [workers] [seed] [replay]\n", *argv);
+      return 1;
+   }
+   if( workers > MAX_WORKERS )
+      workers = MAX_WORKERS;
+   if( workers > games )
+      workers = games;
+
+   static Replay replay;
+   if( argc > 4 && LoadReplay(argv[4], &replay) != 0 )
+   {
+      fprintf(stderr, "Error reading %s\n", argv[4]);
+      return 1;
+   }
+
+   const size_t farm_size = sizeof(Farm) + sizeof(GameResult) * games;
+   Farm *farm = mmap(NULL, farm_size, PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+   if( farm == MAP_FAILED )
+   {
+      perror("mmap");
+      return 1;
+   }
+
+   const double start = GetWallTime();
+   pid_t pid[MAX_WORKERS];
+   for(int w = 0; w < workers; w++)
+      pid[w] = StartWorker(farm, w, games, first_seed,
+                           argc > 4 ? &replay : NULL);
+
+   // Wait for workers, replacing the ones that died in the middle of a
+   // game.  Because the game counter is only incremented, the game that
+   // failed is never retried.
+   for(int running = workers; running > 0;)
+   {
+      int status;
+      const pid_t done = wait(&status);
+      if( done < 0 )
+      {
+         perror("wait");
+         return 1;
+      }
+      running--;
+      for(int w = 0; w < workers; w++)
+      {
+         if( pid[w] != done )
+            continue;
+         if( WIFEXITED(status) && WEXITSTATUS(status) == 0 )
+            break;
+
+         const int game = farm->current_game[w];
+         if( game >= 0 )
+            farm->result[game].status = kGameViolation;
+         if( __atomic_load_n(&(farm->next_game), __ATOMIC_RELAXED) < games )
+         {
+            pid[w] = StartWorker(farm, w, games, first_seed,
+                                 argc > 4 ? &replay : NULL);
+            running++;
+         }
+         break;
+      }
+   }
+
+   return PrintReport(farm, games, workers, first_seed,
+                      GetWallTime() - start) == 0 ? 0 : 1;
+}
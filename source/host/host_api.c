@@ -0,0 +1,940 @@
+#include"host_api.h"
+#include<dirent.h>
+#include<errno.h>
+#include<math.h>
+#include<png.h>
+#include<stdarg.h>
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<time.h>
+#include"common.h"
+
+// Same as SAMPLE_RATE in bgm.h.
+#define HOST_SAMPLE_RATE   44100
+
+// Maximum depth of pushContext calls.
+#define MAX_CONTEXT_DEPTH  16
+
+// Built-in font metrics.  Glyphs are 3x5 pixels scaled by FONT_SCALE, so
+// that text is roughly the same size as the system font used by the game.
+#define GLYPH_COLUMNS      3
+#define GLYPH_ROWS         5
+#define FONT_SCALE         3
+#define FONT_ADVANCE       ((GLYPH_COLUMNS + 1) * FONT_SCALE)
+#define FONT_HEIGHT        ((GLYPH_ROWS + 1) * FONT_SCALE)
+#define FONT_TOP           (FONT_SCALE / 2)
+
+struct LCDBitmap
+{
+   int width, height, row_bytes;
+
+   // Pixel data, 1 being white.
+   uint8_t *data;
+
+   // Mask data, 1 being opaque.  NULL if bitmap doesn't have a mask.
+   uint8_t *mask;
+};
+
+struct LCDBitmapTable
+{
+   int count, columns;
+   LCDBitmap **cell;
+};
+
+struct LCDFont
+{
+   // Only used to give the built-in font a unique address.
+   int unused;
+};
+
+// Saved state for pushContext.
+typedef struct
+{
+   LCDBitmap *target;
+   LCDBitmapDrawMode mode;
+   LCDFont *font;
+} Context;
+
+// Built-in font glyphs for characters 32..95, 5 rows of 3 pixels each.
+static const char kGlyph[64][GLYPH_COLUMNS * GLYPH_ROWS + 1] =
+{
+   "..." "..." "..." "..." "...",  // ' '
+   ".#." ".#." ".#." "..." ".#.",  // '!'
+   "#.#" "#.#" "..." "..." "...",  // '"'
+   "#.#" "###" "#.#" "###" "#.#",  // '#'
+   ".##" "##." ".#." ".##" "##.",  // '$'
+   "#.#" "..#" ".#." "#.." "#.#",  // '%'
+   ".#." "#.#" ".#." "#.#" ".##",  // '&'
+   ".#." ".#." "..." "..." "...",  // '\''
+   "..#" ".#." ".#." ".#." "..#",  // '('
+   "#.." ".#." ".#." ".#." "#..",  // ')'
+   "..." "#.#" ".#." "#.#" "...",  // '*'
+   "..." ".#." "###" ".#." "...",  // '+'
+   "..." "..." "..." ".#." "#..",  // ','
+   "..." "..." "###" "..." "...",  // '-'
+   "..." "..." "..." "..." ".#.",  // '.'
+   "..#" "..#" ".#." "#.." "#..",  // '/'
+   "###" "#.#" "#.#" "#.#" "###",  // '0'
+   ".#." "##." ".#." ".#." "###",  // '1'
+   "###" "..#" "###" "#.." "###",  // '2'
+   "###" "..#" ".##" "..#" "###",  // '3'
+   "#.#" "#.#" "###" "..#" "..#",  // '4'
+   "###" "#.." "###" "..#" "###",  // '5'
+   "###" "#.." "###" "#.#" "###",  // '6'
+   "###" "..#" "..#" ".#." ".#.",  // '7'
+   "###" "#.#" "###" "#.#" "###",  // '8'
+   "###" "#.#" "###" "..#" "###",  // '9'
+   "..." ".#." "..." ".#." "...",  // ':'
+   "..." ".#." "..." ".#." "#..",  // ';'
+   "..#" ".#." "#.." ".#." "..#",  // '<'
+   "..." "###" "..." "###" "...",  // '='
+   "#.." ".#." "..#" ".#." "#..",  // '>'
+   "###" "..#" ".##" "..." ".#.",  // '?'
+   ".#." "#.#" "###" "#.." ".##",  // '@'
+   ".#." "#.#" "###" "#.#" "#.#",  // 'A'
+   "##." "#.#" "##." "#.#" "##.",  // 'B'
+   ".##" "#.." "#.." "#.." ".##",  // 'C'
+   "##." "#.#" "#.#" "#.#" "##.",  // 'D'
+   "###" "#.." "##." "#.." "###",  // 'E'
+   "###" "#.." "##." "#.." "#..",  // 'F'
+   ".##" "#.." "#.#" "#.#" ".##",  // 'G'
+   "#.#" "#.#" "###" "#.#" "#.#",  // 'H'
+   "###" ".#." ".#." ".#." "###",  // 'I'
+   "..#" "..#" "..#" "#.#" ".#.",  // 'J'
+   "#.#" "#.#" "##." "#.#" "#.#",  // 'K'
+   "#.." "#.." "#.." "#.." "###",  // 'L'
+   "#.#" "###" "###" "#.#" "#.#",  // 'M'
+   "##." "#.#" "#.#" "#.#" "#.#",  // 'N'
+   ".#." "#.#" "#.#" "#.#" ".#.",  // 'O'
+   "##." "#.#" "##." "#.." "#..",  // 'P'
+   ".#." "#.#" "#.#" "##." ".##",  // 'Q'
+   "##." "#.#" "##." "#.#" "#.#",  // 'R'
+   ".##" "#.." ".#." "..#" "##.",  // 'S'
+   "###" ".#." ".#." ".#." ".#.",  // 'T'
+   "#.#" "#.#" "#.#" "#.#" "###",  // 'U'
+   "#.#" "#.#" "#.#" "#.#" ".#.",  // 'V'
+   "#.#" "#.#" "###" "###" "#.#",  // 'W'
+   "#.#" "#.#" ".#." "#.#" "#.#",  // 'X'
+   "#.#" "#.#" ".#." ".#." ".#.",  // 'Y'
+   "###" "..#" ".#." "#.." "###",  // 'Z'
+   ".##" ".#." ".#." ".#." ".##",  // '['
+   "#.." "#.." ".#." "..#" "..#",  // '\\'
+   "##." ".#." ".#." ".#." "##.",  // ']'
+   ".#." "#.#" "..." "..." "...",  // '^'
+   "..." "..." "..." "..." "###",  // '_'
+};
+
+// Directory containing images and other files.
+static const char *g_image_dir = ".";
+
+// Frame buffer.
+static uint8_t g_frame_data[SCREEN_STRIDE * SCREEN_HEIGHT];
+static LCDBitmap g_frame =
+{
+   SCREEN_WIDTH, SCREEN_HEIGHT, SCREEN_STRIDE, g_frame_data, NULL
+};
+
+// Built-in font.
+static LCDFont g_builtin_font;
+
+// Drawing state.
+static Context g_context[MAX_CONTEXT_DEPTH];
+static int g_context_depth = 0;
+static LCDBitmap *g_target = &g_frame;
+static LCDBitmapDrawMode g_draw_mode = kDrawModeCopy;
+static LCDFont *g_font = &g_builtin_font;
+
+// Last file error.
+static const char *g_file_error = "";
+
+// Time of InitHostAPI call.
+static struct timespec g_start_time;
+
+// Elapsed time reference for getElapsedTime.  This is kept as double so
+// that elapsed times stay accurate to the microsecond however long the
+// program has been running, which the profiler depends on (see profile.h).
+static double g_elapsed_start = 0;
+
+// Print an error and exit.
+static void Error(const char *format, ...)
+{
+   va_list args;
+   va_start(args, format);
+   vfprintf(stderr, format, args);
+   va_end(args);
+   fputc('\n', stderr);
+   exit(EXIT_FAILURE);
+}
+
+// Allocate memory, exiting on failure.
+static void *Allocate(size_t size)
+{
+   void *p = calloc(size, 1);
+   if( p == NULL )
+      Error("Out of memory");
+   return p;
+}
+
+// Build path relative to image directory.  Caller must free the result.
+static char *GetFullPath(const char *path, const char *suffix)
+{
+   char *full_path = Allocate(
+      strlen(g_image_dir) + strlen(path) + strlen(suffix) + 2);
+   sprintf(full_path, "%s/%s%s", g_image_dir, path, suffix);
+   return full_path;
+}
+
+// {{{ Pixel operations.
+
+static int Min(int a, int b) { return a < b ? a : b; }
+static int Max(int a, int b) { return a > b ? a : b; }
+
+static int GetBit(const uint8_t *row, int x)
+{
+   return (row[x >> 3] >> (7 - (x & 7))) & 1;
+}
+
+static void SetBit(uint8_t *row, int x, int value)
+{
+   const uint8_t bit = 0x80 >> (x & 7);
+   if( value )
+      row[x >> 3] |= bit;
+   else
+      row[x >> 3] &= ~bit;
+}
+
+// Write a single pixel to bitmap, making it opaque.  Coordinates must be
+// within bounds.
+static void WritePixel(LCDBitmap *bitmap, int x, int y, int white)
+{
+   SetBit(bitmap->data + y * bitmap->row_bytes, x, white);
+   if( bitmap->mask != NULL )
+      SetBit(bitmap->mask + y * bitmap->row_bytes, x, 1);
+}
+
+// Draw a single opaque source pixel using the current draw mode.
+static void DrawPixel(LCDBitmap *target, int x, int y, int white)
+{
+   if( x < 0 || x >= target->width || y < 0 || y >= target->height )
+      return;
+
+   const int old = GetBit(target->data + y * target->row_bytes, x);
+   switch( g_draw_mode )
+   {
+      case kDrawModeCopy:
+         WritePixel(target, x, y, white);
+         break;
+      case kDrawModeWhiteTransparent:
+         if( !white )
+            WritePixel(target, x, y, 0);
+         break;
+      case kDrawModeBlackTransparent:
+         if( white )
+            WritePixel(target, x, y, 1);
+         break;
+      case kDrawModeFillWhite:
+         WritePixel(target, x, y, 1);
+         break;
+      case kDrawModeFillBlack:
+         WritePixel(target, x, y, 0);
+         break;
+      case kDrawModeXOR:
+         WritePixel(target, x, y, old ^ white);
+         break;
+      case kDrawModeNXOR:
+         WritePixel(target, x, y, old ^ !white);
+         break;
+      case kDrawModeInverted:
+         WritePixel(target, x, y, !white);
+         break;
+   }
+}
+
+// Fill a rectangle in bitmap with a color, clipped to bitmap bounds.
+static void FillBitmapRect(LCDBitmap *bitmap,
+                           int x, int y, int width, int height,
+                           LCDColor color)
+{
+   const int x0 = Max(x, 0);
+   const int y0 = Max(y, 0);
+   const int x1 = Min(x + width, bitmap->width);
+   const int y1 = Min(y + height, bitmap->height);
+   for(int ty = y0; ty < y1; ty++)
+   {
+      uint8_t *row = bitmap->data + ty * bitmap->row_bytes;
+      uint8_t *mask_row = bitmap->mask == NULL
+                          ? NULL : bitmap->mask + ty * bitmap->row_bytes;
+      for(int tx = x0; tx < x1; tx++)
+      {
+         switch( color )
+         {
+            case kColorBlack:
+            case kColorWhite:
+               WritePixel(bitmap, tx, ty, color == kColorWhite);
+               break;
+            case kColorClear:
+               SetBit(row, tx, 0);
+               if( mask_row != NULL )
+                  SetBit(mask_row, tx, 0);
+               break;
+            case kColorXOR:
+               WritePixel(bitmap, tx, ty, !GetBit(row, tx));
+               break;
+            default:
+               {
+                  const uint8_t *pattern = (const uint8_t*)color;
+                  if( GetBit(pattern + 8 + (ty & 7), tx & 7) )
+                     WritePixel(bitmap, tx, ty, GetBit(pattern + (ty & 7), tx & 7));
+               }
+               break;
+         }
+      }
+   }
+}
+
+// Allocate a bitmap without initializing pixels.
+static LCDBitmap *AllocateBitmap(int width, int height, int with_mask)
+{
+   LCDBitmap *bitmap = Allocate(sizeof(LCDBitmap));
+   bitmap->width = width;
+   bitmap->height = height;
+   bitmap->row_bytes = ((width + 31) / 32) * 4;
+   bitmap->data = Allocate(bitmap->row_bytes * height);
+   if( with_mask )
+      bitmap->mask = Allocate(bitmap->row_bytes * height);
+   return bitmap;
+}
+
+// }}}
+
+// {{{ Graphics functions.
+
+static void Clear(LCDColor color)
+{
+   FillBitmapRect(&g_frame, 0, 0, SCREEN_WIDTH, SCREEN_HEIGHT, color);
+}
+
+static LCDBitmapDrawMode SetDrawMode(LCDBitmapDrawMode mode)
+{
+   const LCDBitmapDrawMode old = g_draw_mode;
+   g_draw_mode = mode;
+   return old;
+}
+
+static void SetFont(LCDFont *font)
+{
+   g_font = font;
+}
+
+static void PushContext(LCDBitmap *target)
+{
+   if( g_context_depth == MAX_CONTEXT_DEPTH )
+      Error("pushContext: too many contexts");
+   Context *c = g_context + g_context_depth++;
+   c->target = g_target;
+   c->mode = g_draw_mode;
+   c->font = g_font;
+   g_target = target == NULL ? &g_frame : target;
+}
+
+static void PopContext(void)
+{
+   if( g_context_depth == 0 )
+      Error("popContext: no context");
+   const Context *c = g_context + --g_context_depth;
+   g_target = c->target;
+   g_draw_mode = c->mode;
+   g_font = c->font;
+}
+
+static void DrawBitmap(LCDBitmap *bitmap, int x, int y, LCDBitmapFlip flip)
+{
+   const int flip_x = flip == kBitmapFlippedX || flip == kBitmapFlippedXY;
+   const int flip_y = flip == kBitmapFlippedY || flip == kBitmapFlippedXY;
+   const int x0 = Max(x, 0);
+   const int y0 = Max(y, 0);
+   const int x1 = Min(x + bitmap->width, g_target->width);
+   const int y1 = Min(y + bitmap->height, g_target->height);
+   for(int ty = y0; ty < y1; ty++)
+   {
+      const int sy = flip_y ? bitmap->height - 1 - (ty - y) : ty - y;
+      const uint8_t *row = bitmap->data + sy * bitmap->row_bytes;
+      const uint8_t *mask_row = bitmap->mask == NULL
+                                ? NULL : bitmap->mask + sy * bitmap->row_bytes;
+      for(int tx = x0; tx < x1; tx++)
+      {
+         const int sx = flip_x ? bitmap->width - 1 - (tx - x) : tx - x;
+         if( mask_row == NULL || GetBit(mask_row, sx) )
+            DrawPixel(g_target, tx, ty, GetBit(row, sx));
+      }
+   }
+}
+
+static void FillRect(int x, int y, int width, int height, LCDColor color)
+{
+   FillBitmapRect(g_target, x, y, width, height, color);
+}
+
+// Get glyph for a character.
+static const char *GetGlyph(char c)
+{
+   if( c >= 'a' && c <= 'z' )
+      c = c - 'a' + 'A';
+   if( c < ' ' || c > '_' )
+      c = '?';
+   return kGlyph[c - ' '];
+}
+
+static int GetTextWidth(LCDFont *font, const void *text, size_t len,
+                        PDStringEncoding encoding, int tracking)
+{
+   (void)font;
+   (void)text;
+   (void)encoding;
+   return (int)len * (FONT_ADVANCE + tracking);
+}
+
+static int DrawText(const void *text, size_t len, PDStringEncoding encoding,
+                    int x, int y)
+{
+   (void)encoding;
+   for(size_t i = 0; i < len; i++)
+   {
+      const char *glyph = GetGlyph(((const char*)text)[i]);
+      for(int gy = 0; gy < GLYPH_ROWS; gy++)
+      {
+         for(int gx = 0; gx < GLYPH_COLUMNS; gx++)
+         {
+            if( glyph[gy * GLYPH_COLUMNS + gx] != '#' )
+               continue;
+            for(int sy = 0; sy < FONT_SCALE; sy++)
+            {
+               for(int sx = 0; sx < FONT_SCALE; sx++)
+               {
+                  DrawPixel(g_target,
+                            x + gx * FONT_SCALE + sx,
+                            y + FONT_TOP + gy * FONT_SCALE + sy,
+                            0);
+               }
+            }
+         }
+      }
+      x += FONT_ADVANCE;
+   }
+   return GetTextWidth(g_font, text, len, encoding, 0);
+}
+
+static LCDBitmap *NewBitmap(int width, int height, LCDColor bgcolor)
+{
+   LCDBitmap *bitmap = AllocateBitmap(width, height, bgcolor == kColorClear);
+   FillBitmapRect(bitmap, 0, 0, width, height, bgcolor);
+   return bitmap;
+}
+
+static void FreeBitmap(LCDBitmap *bitmap)
+{
+   if( bitmap == NULL )
+      return;
+   free(bitmap->data);
+   free(bitmap->mask);
+   free(bitmap);
+}
+
+// Load a PNG file.  Sets *columns and *rows to number of cells.
+static LCDBitmap **LoadPNG(const char *path, int cell_width, int cell_height,
+                           int *columns, int *rows)
+{
+   png_image image;
+   memset(&image, 0, sizeof(image));
+   image.version = PNG_IMAGE_VERSION;
+   if( !png_image_begin_read_from_file(&image, path) )
+      return NULL;
+   image.format = PNG_FORMAT_GA;
+   png_bytep pixels = Allocate(PNG_IMAGE_SIZE(image));
+   if( !png_image_finish_read(&image, NULL, pixels, 0, NULL) )
+      Error("%s: %s", path, image.message);
+
+   if( cell_width <= 0 )
+   {
+      cell_width = image.width;
+      cell_height = image.height;
+   }
+   if( (int)image.width % cell_width != 0 ||
+       (int)image.height % cell_height != 0 )
+   {
+      Error("%s: invalid table dimension", path);
+   }
+   *columns = image.width / cell_width;
+   *rows = image.height / cell_height;
+
+   // Pixels with gray value >= 128 are white, and pixels with alpha >= 128
+   // are opaque, same as data/pack_bundle.c.
+   LCDBitmap **cell = Allocate(*columns * *rows * sizeof(LCDBitmap*));
+   for(int i = 0; i < *columns * *rows; i++)
+   {
+      const int cell_x = (i % *columns) * cell_width;
+      const int cell_y = (i / *columns) * cell_height;
+
+      int opaque = 1;
+      for(int y = 0; y < cell_height && opaque; y++)
+      {
+         for(int x = 0; x < cell_width; x++)
+         {
+            if( pixels[2 * ((cell_y + y) * image.width + cell_x + x) + 1] < 128 )
+            {
+               opaque = 0;
+               break;
+            }
+         }
+      }
+
+      LCDBitmap *bitmap = AllocateBitmap(cell_width, cell_height, !opaque);
+      for(int y = 0; y < cell_height; y++)
+      {
+         for(int x = 0; x < cell_width; x++)
+         {
+            const png_bytep p =
+               pixels + 2 * ((cell_y + y) * image.width + cell_x + x);
+            SetBit(bitmap->data + y * bitmap->row_bytes, x, p[0] >= 128);
+            if( bitmap->mask != NULL )
+               SetBit(bitmap->mask + y * bitmap->row_bytes, x, p[1] >= 128);
+         }
+      }
+      cell[i] = bitmap;
+   }
+   free(pixels);
+   return cell;
+}
+
+static LCDBitmap *LoadBitmap(const char *path, const char **outerr)
+{
+   char *full_path = GetFullPath(path, ".png");
+   int columns, rows;
+   LCDBitmap **cell = LoadPNG(full_path, 0, 0, &columns, &rows);
+   free(full_path);
+   if( cell == NULL )
+   {
+      *outerr = "file not found";
+      return NULL;
+   }
+   LCDBitmap *bitmap = cell[0];
+   free(cell);
+   return bitmap;
+}
+
+static void GetBitmapData(LCDBitmap *bitmap, int *width, int *height,
+                          int *rowbytes, uint8_t **mask, uint8_t **data)
+{
+   if( width != NULL )
+      *width = bitmap->width;
+   if( height != NULL )
+      *height = bitmap->height;
+   if( rowbytes != NULL )
+      *rowbytes = bitmap->row_bytes;
+   if( mask != NULL )
+      *mask = bitmap->mask;
+   if( data != NULL )
+      *data = bitmap->data;
+}
+
+static void ClearBitmap(LCDBitmap *bitmap, LCDColor bgcolor)
+{
+   if( bgcolor == kColorClear && bitmap->mask == NULL )
+      bitmap->mask = Allocate(bitmap->row_bytes * bitmap->height);
+   FillBitmapRect(bitmap, 0, 0, bitmap->width, bitmap->height, bgcolor);
+}
+
+static LCDBitmapTable *NewBitmapTable(int count, int width, int height)
+{
+   LCDBitmapTable *table = Allocate(sizeof(LCDBitmapTable));
+   table->count = count;
+   table->columns = count;
+   table->cell = Allocate(count * sizeof(LCDBitmap*));
+   for(int i = 0; i < count; i++)
+      table->cell[i] = NewBitmap(width, height, kColorWhite);
+   return table;
+}
+
+static void FreeBitmapTable(LCDBitmapTable *table)
+{
+   if( table == NULL )
+      return;
+   for(int i = 0; i < table->count; i++)
+      FreeBitmap(table->cell[i]);
+   free(table->cell);
+   free(table);
+}
+
+static LCDBitmapTable *LoadBitmapTable(const char *path, const char **outerr)
+{
+   // Find "{path}-table-{w}-{h}.png" in image directory.
+   const char *base = strrchr(path, '/');
+   base = base == NULL ? path : base + 1;
+   char *dir_path = GetFullPath(path, "");
+   dir_path[strlen(dir_path) - strlen(base)] = '\0';
+   DIR *dir = opendir(dir_path);
+   if( dir == NULL )
+      Error("%s: %s", dir_path, strerror(errno));
+
+   const size_t base_length = strlen(base);
+   int cell_width = 0, cell_height = 0;
+   for(struct dirent *entry; (entry = readdir(dir)) != NULL;)
+   {
+      if( strncmp(entry->d_name, base, base_length) == 0 &&
+          sscanf(entry->d_name + base_length, "-table-%d-%d.png",
+                 &cell_width, &cell_height) == 2 )
+      {
+         break;
+      }
+      cell_width = 0;
+   }
+   closedir(dir);
+   free(dir_path);
+   if( cell_width <= 0 || cell_height <= 0 )
+   {
+      *outerr = "file not found";
+      return NULL;
+   }
+
+   char suffix[64];
+   sprintf(suffix, "-table-%d-%d.png", cell_width, cell_height);
+   char *full_path = GetFullPath(path, suffix);
+   LCDBitmapTable *table = Allocate(sizeof(LCDBitmapTable));
+   int rows;
+   table->cell = LoadPNG(full_path, cell_width, cell_height,
+                         &table->columns, &rows);
+   if( table->cell == NULL )
+      Error("%s: error loading table", full_path);
+   table->count = table->columns * rows;
+   free(full_path);
+   return table;
+}
+
+static LCDBitmap *GetTableBitmap(LCDBitmapTable *table, int idx)
+{
+   return idx >= 0 && idx < table->count ? table->cell[idx] : NULL;
+}
+
+static LCDFont *LoadFont(const char *path, const char **outErr)
+{
+   (void)path;
+   (void)outErr;
+   return &g_builtin_font;
+}
+
+static uint8_t *GetFrame(void)
+{
+   return g_frame_data;
+}
+
+static void MarkUpdatedRows(int start, int end)
+{
+   (void)start;
+   (void)end;
+}
+
+static uint8_t GetFontHeight(LCDFont *font)
+{
+   (void)font;
+   return FONT_HEIGHT;
+}
+
+static int SetBitmapMask(LCDBitmap *bitmap, LCDBitmap *mask)
+{
+   if( mask->width != bitmap->width || mask->height != bitmap->height )
+      return 0;
+   if( bitmap->mask == NULL )
+      bitmap->mask = Allocate(bitmap->row_bytes * bitmap->height);
+   for(int y = 0; y < bitmap->height; y++)
+   {
+      memcpy(bitmap->mask + y * bitmap->row_bytes,
+             mask->data + y * mask->row_bytes,
+             bitmap->row_bytes);
+   }
+   return 1;
+}
+
+static int GetTextTracking(void)
+{
+   return 0;
+}
+
+static void GetBitmapTableInfo(LCDBitmapTable *table, int *count, int *width)
+{
+   if( count != NULL )
+      *count = table->count;
+   if( width != NULL )
+      *width = table->columns;
+}
+
+static void DrawRotatedBitmap(LCDBitmap *bitmap, int x, int y, float rotation,
+                              float centerx, float centery,
+                              float xscale, float yscale)
+{
+   // Rotation is clockwise in degrees.  For each target pixel within the
+   // bounding circle, sample the source pixel with inverse transform.
+   const float radians = rotation * (float)M_PI / 180.0f;
+   const float c = cosf(radians);
+   const float s = sinf(radians);
+   const float w = bitmap->width * xscale;
+   const float h = bitmap->height * yscale;
+   const int radius = (int)ceilf(sqrtf(w * w + h * h));
+   for(int ty = y - radius; ty <= y + radius; ty++)
+   {
+      for(int tx = x - radius; tx <= x + radius; tx++)
+      {
+         const float dx = tx + 0.5f - x;
+         const float dy = ty + 0.5f - y;
+         const int sx = (int)floorf((dx * c + dy * s) / xscale +
+                                    centerx * bitmap->width);
+         const int sy = (int)floorf((dy * c - dx * s) / yscale +
+                                    centery * bitmap->height);
+         if( sx < 0 || sx >= bitmap->width || sy < 0 || sy >= bitmap->height )
+            continue;
+         if( bitmap->mask == NULL ||
+             GetBit(bitmap->mask + sy * bitmap->row_bytes, sx) )
+         {
+            DrawPixel(g_target, tx, ty,
+                      GetBit(bitmap->data + sy * bitmap->row_bytes, sx));
+         }
+      }
+   }
+}
+
+// }}}
+
+// {{{ System functions.
+
+static void *Realloc(void *ptr, size_t size)
+{
+   if( size == 0 )
+   {
+      free(ptr);
+      return NULL;
+   }
+   return realloc(ptr, size);
+}
+
+static int FormatString(char **ret, const char *fmt, ...)
+{
+   va_list args;
+   va_start(args, fmt);
+   const int length = vsnprintf(NULL, 0, fmt, args);
+   va_end(args);
+
+   *ret = Allocate(length + 1);
+   va_start(args, fmt);
+   vsnprintf(*ret, length + 1, fmt, args);
+   va_end(args);
+   return length;
+}
+
+static void LogToConsole(const char *fmt, ...)
+{
+   va_list args;
+   va_start(args, fmt);
+   vfprintf(stderr, fmt, args);
+   va_end(args);
+   fputc('\n', stderr);
+}
+
+// Get time since InitHostAPI in seconds.
+static double GetHostTime(void)
+{
+   struct timespec now;
+   clock_gettime(CLOCK_MONOTONIC, &now);
+   return (double)(now.tv_sec - g_start_time.tv_sec) +
+          (double)(now.tv_nsec - g_start_time.tv_nsec) * 1e-9;
+}
+
+static unsigned int GetCurrentTimeMilliseconds(void)
+{
+   return (unsigned int)(GetHostTime() * 1000);
+}
+
+static float GetElapsedTime(void)
+{
+   return (float)(GetHostTime() - g_elapsed_start);
+}
+
+static void ResetElapsedTime(void)
+{
+   g_elapsed_start = GetHostTime();
+}
+
+static uint32_t GetCurrentTime(void)
+{
+   return (uint32_t)(GetHostTime() * HOST_SAMPLE_RATE);
+}
+
+// }}}
+
+// {{{ File functions.
+
+static SDFile *FileOpen(const char *name, FileOptions mode)
+{
+   char *full_path = GetFullPath(name, "");
+   FILE *file = fopen(full_path, (mode & kFileAppend) == kFileAppend ? "ab"
+                                 : (mode & kFileWrite) != 0 ? "wb" : "rb");
+   free(full_path);
+   if( file == NULL )
+      g_file_error = strerror(errno);
+   return file;
+}
+
+static int FileClose(SDFile *file)
+{
+   return fclose((FILE*)file);
+}
+
+static int FileRead(SDFile *file, void *buf, unsigned int len)
+{
+   return (int)fread(buf, 1, len, (FILE*)file);
+}
+
+static int FileWrite(SDFile *file, const void *buf, unsigned int len)
+{
+   return (int)fwrite(buf, 1, len, (FILE*)file);
+}
+
+static int FileFlush(SDFile *file)
+{
+   return fflush((FILE*)file);
+}
+
+static int FileSeek(SDFile *file, int pos, int whence)
+{
+   return fseek((FILE*)file, pos, whence);
+}
+
+static int FileStatPath(const char *path, FileStat *stat)
+{
+   char *full_path = GetFullPath(path, "");
+   FILE *file = fopen(full_path, "rb");
+   free(full_path);
+   if( file == NULL )
+   {
+      g_file_error = strerror(errno);
+      return -1;
+   }
+   fseek(file, 0, SEEK_END);
+   memset(stat, 0, sizeof(FileStat));
+   stat->size = (unsigned int)ftell(file);
+   fclose(file);
+   return 0;
+}
+
+static const char *FileGetErr(void)
+{
+   return g_file_error;
+}
+
+// }}}
+
+PlaydateAPI *InitHostAPI(const char *image_dir)
+{
+   static const struct playdate_graphics kGraphics =
+   {
+      .clear = Clear,
+      .setDrawMode = SetDrawMode,
+      .setFont = SetFont,
+      .pushContext = PushContext,
+      .popContext = PopContext,
+      .drawBitmap = DrawBitmap,
+      .fillRect = FillRect,
+      .drawText = DrawText,
+      .newBitmap = NewBitmap,
+      .freeBitmap = FreeBitmap,
+      .loadBitmap = LoadBitmap,
+      .getBitmapData = GetBitmapData,
+      .clearBitmap = ClearBitmap,
+      .newBitmapTable = NewBitmapTable,
+      .freeBitmapTable = FreeBitmapTable,
+      .loadBitmapTable = LoadBitmapTable,
+      .getTableBitmap = GetTableBitmap,
+      .loadFont = LoadFont,
+      .getTextWidth = GetTextWidth,
+      .getFrame = GetFrame,
+      .markUpdatedRows = MarkUpdatedRows,
+      .getFontHeight = GetFontHeight,
+      .setBitmapMask = SetBitmapMask,
+      .getTextTracking = GetTextTracking,
+      .getBitmapTableInfo = GetBitmapTableInfo,
+      .drawRotatedBitmap = DrawRotatedBitmap,
+   };
+   static const struct playdate_sys kSystem =
+   {
+      .realloc = Realloc,
+      .formatString = FormatString,
+      .logToConsole = LogToConsole,
+      .error = Error,
+      .getCurrentTimeMilliseconds = GetCurrentTimeMilliseconds,
+      .getElapsedTime = GetElapsedTime,
+      .resetElapsedTime = ResetElapsedTime,
+   };
+   static const struct playdate_file kFile =
+   {
+      .open = FileOpen,
+      .close = FileClose,
+      .read = FileRead,
+      .write = FileWrite,
+      .flush = FileFlush,
+      .seek = FileSeek,
+      .stat = FileStatPath,
+      .geterr = FileGetErr,
+   };
+   static const struct playdate_sound kSound =
+   {
+      .getCurrentTime = GetCurrentTime,
+   };
+   static PlaydateAPI api =
+   {
+      .system = &kSystem,
+      .file = &kFile,
+      .graphics = &kGraphics,
+      .sound = &kSound,
+   };
+
+   g_image_dir = image_dir;
+   clock_gettime(CLOCK_MONOTONIC, &g_start_time);
+   g_context_depth = 0;
+   g_target = &g_frame;
+   g_draw_mode = kDrawModeCopy;
+   g_font = &g_builtin_font;
+   memset(g_frame_data, 0xff, sizeof(g_frame_data));
+   return &api;
+}
+
+uint8_t *GetHostFrame(void)
+{
+   return g_frame_data;
+}
+
+uint32_t GetHostFrameChecksum(void)
+{
+   // FNV-1a over visible pixels only, so that padding bits don't matter.
+   uint32_t hash = 2166136261u;
+   for(int y = 0; y < SCREEN_HEIGHT; y++)
+   {
+      for(int x = 0; x < SCREEN_WIDTH / 8; x++)
+         hash = (hash ^ g_frame_data[y * SCREEN_STRIDE + x]) * 16777619u;
+   }
+   return hash;
+}
+
+int WriteHostFrame(const char *path)
+{
+   FILE *outfile = fopen(path, "wb");
+   if( outfile == NULL )
+      return 1;
+
+   // PBM uses 1 for black, so bits are inverted.
+   fprintf(outfile, "P4\n%d %d\n", SCREEN_WIDTH, SCREEN_HEIGHT);
+   for(int y = 0; y < SCREEN_HEIGHT; y++)
+   {
+      for(int x = 0; x < SCREEN_WIDTH / 8; x++)
+         fputc(~g_frame_data[y * SCREEN_STRIDE + x] & 0xff, outfile);
+   }
+   return fclose(outfile) != 0;
+}
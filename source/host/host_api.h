@@ -0,0 +1,49 @@
+// Library for running game code on the host, without Playdate SDK.
+//
+// This implements the subset of Playdate API used by world.c, slime.c,
+// hud.c and images.c, so that rendering can be benchmarked and tested on
+// Linux.  Drawing goes to a 400x240 1-bit frame buffer with the same layout
+// as the device (SCREEN_STRIDE bytes per row, most significant bit first,
+// 1 being white), following these semantics:
+//
+// - Bitmaps with a mask only draw their opaque pixels.  Drawing into a
+//   bitmap with a mask makes the drawn pixels opaque, and filling with
+//   kColorClear makes them transparent.
+//
+// - drawBitmap and drawText apply the current draw mode.  fillRect ignores
+//   draw mode, and LCDPattern rows are aligned to target coordinates.
+//
+// - pushContext saves draw mode and font, which are restored by popContext.
+//
+// Images are loaded from PNG files in the image directory instead of
+// compiled .pdi/.pdt files: loadBitmapTable("x") reads "x-table-w-h.png",
+// and loadBitmap("x") reads "x.png".  Other files are also opened relative
+// to the image directory.
+//
+// System fonts are not available, so loadFont returns a built-in font
+// regardless of path.  The built-in font only has uppercase letters,
+// digits, and some punctuation, with lowercase letters drawn as uppercase.
+//
+// Audio, input, and menu functions are not implemented, and their function
+// pointers are NULL.  All errors are fatal.
+
+#ifndef HOST_API_H_
+#define HOST_API_H_
+
+#include<stdint.h>
+#include"pd_api.h"
+
+// Initialize host API, returning a pointer to static data.
+PlaydateAPI *InitHostAPI(const char *image_dir);
+
+// Get pointer to frame buffer, same as graphics->getFrame.
+uint8_t *GetHostFrame(void);
+
+// Compute checksum of frame buffer contents, for comparing rendering
+// output between different builds.
+uint32_t GetHostFrameChecksum(void);
+
+// Write frame buffer as a PBM file.  Returns 0 on success.
+int WriteHostFrame(const char *path);
+
+#endif  // HOST_API_H_
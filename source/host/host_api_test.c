@@ -0,0 +1,228 @@
+#include<assert.h>
+#include<stdio.h>
+#include<string.h>
+#include"host_api.h"
+
+static PlaydateAPI *g_pd;
+
+// Get a single pixel from frame buffer, 1 being white.
+static int GetFramePixel(int x, int y)
+{
+   return (GetHostFrame()[y * LCD_ROWSIZE + x / 8] >> (7 - x % 8)) & 1;
+}
+
+// Get a single pixel from bitmap.
+static int GetBitmapPixel(LCDBitmap *bitmap, int x, int y, int from_mask)
+{
+   int row_bytes;
+   uint8_t *mask, *data;
+   g_pd->graphics->getBitmapData(bitmap, NULL, NULL, &row_bytes, &mask, &data);
+   const uint8_t *p = from_mask ? mask : data;
+   assert(p != NULL);
+   return (p[y * row_bytes + x / 8] >> (7 - x % 8)) & 1;
+}
+
+static void TestFillRect(void)
+{
+   g_pd->graphics->clear(kColorWhite);
+   g_pd->graphics->fillRect(-10, -10, 20, 20, kColorBlack);
+   assert(GetFramePixel(0, 0) == 0);
+   assert(GetFramePixel(9, 9) == 0);
+   assert(GetFramePixel(10, 9) == 1);
+   assert(GetFramePixel(9, 10) == 1);
+
+   // Clipped at bottom right corner.
+   g_pd->graphics->fillRect(LCD_COLUMNS - 1, LCD_ROWS - 1, 10, 10,
+                            kColorBlack);
+   assert(GetFramePixel(LCD_COLUMNS - 1, LCD_ROWS - 1) == 0);
+   assert(GetFramePixel(LCD_COLUMNS - 2, LCD_ROWS - 1) == 1);
+
+   g_pd->graphics->fillRect(0, 0, 11, 1, kColorXOR);
+   assert(GetFramePixel(0, 0) == 1);
+   assert(GetFramePixel(9, 0) == 1);
+   assert(GetFramePixel(10, 0) == 0);
+
+   // Pattern rows are aligned to screen coordinates, not to rectangle.
+   // Pixels with cleared mask bits are left untouched.
+   static const LCDPattern kPattern =
+   {
+      0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01,
+      0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xfe
+   };
+   g_pd->graphics->clear(kColorBlack);
+   g_pd->graphics->fillRect(13, 21, 8, 8, (LCDColor)kPattern);
+   for(int y = 21; y < 29; y++)
+   {
+      for(int x = 13; x < 21; x++)
+      {
+         const int expected = (y % 8 == 7 && x % 8 == 7) ? 0
+                              : (x % 8 == y % 8);
+         assert(GetFramePixel(x, y) == expected);
+      }
+   }
+   assert(GetFramePixel(12, 21) == 0);
+   assert(GetFramePixel(21, 21) == 0);
+}
+
+static void TestDrawModes(void)
+{
+   // 3x1 bitmap with black, white, and transparent pixels.
+   LCDBitmap *bitmap = g_pd->graphics->newBitmap(3, 1, kColorClear);
+   g_pd->graphics->pushContext(bitmap);
+   g_pd->graphics->fillRect(0, 0, 1, 1, kColorBlack);
+   g_pd->graphics->fillRect(1, 0, 1, 1, kColorWhite);
+   g_pd->graphics->popContext();
+
+   // Expected output for each mode, drawn over black background at y=0
+   // and white background at y=1.
+   static const struct
+   {
+      LCDBitmapDrawMode mode;
+      const char *expected[2];
+   } kTests[] =
+   {
+      {kDrawModeCopy,             {"010", "011"}},
+      {kDrawModeWhiteTransparent, {"000", "011"}},
+      {kDrawModeBlackTransparent, {"010", "111"}},
+      {kDrawModeFillWhite,        {"110", "111"}},
+      {kDrawModeFillBlack,        {"000", "001"}},
+      {kDrawModeXOR,              {"010", "101"}},
+      {kDrawModeNXOR,             {"100", "011"}},
+      {kDrawModeInverted,         {"100", "101"}},
+   };
+   for(size_t i = 0; i < sizeof(kTests) / sizeof(kTests[0]); i++)
+   {
+      g_pd->graphics->clear(kColorWhite);
+      g_pd->graphics->fillRect(0, 0, 3, 1, kColorBlack);
+      g_pd->graphics->setDrawMode(kTests[i].mode);
+      g_pd->graphics->drawBitmap(bitmap, 0, 0, kBitmapUnflipped);
+      g_pd->graphics->drawBitmap(bitmap, 0, 1, kBitmapUnflipped);
+      for(int y = 0; y < 2; y++)
+      {
+         for(int x = 0; x < 3; x++)
+            assert(GetFramePixel(x, y) == kTests[i].expected[y][x] - '0');
+      }
+   }
+   g_pd->graphics->setDrawMode(kDrawModeCopy);
+
+   // Flipped and clipped.
+   g_pd->graphics->clear(kColorWhite);
+   g_pd->graphics->drawBitmap(bitmap, 0, 0, kBitmapFlippedX);
+   assert(GetFramePixel(0, 0) == 1);
+   assert(GetFramePixel(1, 0) == 1);
+   assert(GetFramePixel(2, 0) == 0);
+   g_pd->graphics->drawBitmap(bitmap, -2, 1, kBitmapFlippedXY);
+   assert(GetFramePixel(0, 1) == 0);
+   assert(GetFramePixel(1, 1) == 1);
+
+   g_pd->graphics->freeBitmap(bitmap);
+}
+
+static void TestContext(void)
+{
+   // Drawing into a bitmap makes drawn pixels opaque.
+   LCDBitmap *bitmap = g_pd->graphics->newBitmap(16, 2, kColorClear);
+   assert(GetBitmapPixel(bitmap, 0, 0, 1) == 0);
+   g_pd->graphics->setDrawMode(kDrawModeFillWhite);
+   g_pd->graphics->pushContext(bitmap);
+   g_pd->graphics->setDrawMode(kDrawModeCopy);
+   g_pd->graphics->fillRect(8, 1, 8, 1, kColorBlack);
+   g_pd->graphics->popContext();
+   assert(GetBitmapPixel(bitmap, 7, 1, 1) == 0);
+   assert(GetBitmapPixel(bitmap, 8, 1, 1) == 1);
+   assert(GetBitmapPixel(bitmap, 8, 1, 0) == 0);
+
+   // Draw mode is restored by popContext.
+   assert(g_pd->graphics->setDrawMode(kDrawModeCopy) == kDrawModeFillWhite);
+
+   // Drawing after popContext goes to the frame buffer.
+   g_pd->graphics->clear(kColorWhite);
+   g_pd->graphics->drawBitmap(bitmap, 0, 0, kBitmapUnflipped);
+   assert(GetFramePixel(7, 1) == 1);
+   assert(GetFramePixel(8, 1) == 0);
+
+   g_pd->graphics->clearBitmap(bitmap, kColorClear);
+   assert(GetBitmapPixel(bitmap, 8, 1, 1) == 0);
+   g_pd->graphics->freeBitmap(bitmap);
+}
+
+static void TestText(void)
+{
+   LCDFont *font = g_pd->graphics->loadFont("any", NULL);
+   assert(font != NULL);
+   const int height = g_pd->graphics->getFontHeight(font);
+   const int width = g_pd->graphics->getTextWidth(
+      font, "10", 2, kASCIIEncoding, 0);
+   assert(width > 0);
+   assert(height > 0);
+
+   // Text is drawn in black with transparent background.
+   g_pd->graphics->clear(kColorWhite);
+   g_pd->graphics->setFont(font);
+   g_pd->graphics->drawText("10", 2, kASCIIEncoding, 0, 0);
+   int black = 0;
+   for(int y = 0; y < LCD_ROWS; y++)
+   {
+      for(int x = 0; x < LCD_COLUMNS; x++)
+      {
+         if( GetFramePixel(x, y) == 0 )
+         {
+            assert(x < width);
+            assert(y < height);
+            black++;
+         }
+      }
+   }
+   assert(black > 0);
+
+   // Lowercase letters are drawn same as uppercase.
+   g_pd->graphics->clear(kColorWhite);
+   g_pd->graphics->drawText("A", 1, kASCIIEncoding, 0, 0);
+   const uint32_t upper = GetHostFrameChecksum();
+   g_pd->graphics->clear(kColorWhite);
+   g_pd->graphics->drawText("a", 1, kASCIIEncoding, 0, 0);
+   assert(GetHostFrameChecksum() == upper);
+}
+
+static void TestLoadImages(void)
+{
+   const char *error = NULL;
+   LCDBitmapTable *table = g_pd->graphics->loadBitmapTable("eyes", &error);
+   assert(table != NULL);
+   int count, columns;
+   g_pd->graphics->getBitmapTableInfo(table, &count, &columns);
+   assert(count > 0);
+   assert(columns > 0);
+
+   int width, height;
+   g_pd->graphics->getBitmapData(g_pd->graphics->getTableBitmap(table, 0),
+                                 &width, &height, NULL, NULL, NULL);
+   assert(width == 12);
+   assert(height == 12);
+   assert(g_pd->graphics->getTableBitmap(table, count) == NULL);
+   g_pd->graphics->freeBitmapTable(table);
+
+   assert(g_pd->graphics->loadBitmapTable("missing", &error) == NULL);
+   assert(error != NULL);
+
+   LCDBitmap *bitmap = g_pd->graphics->loadBitmap("title", &error);
+   assert(bitmap != NULL);
+   g_pd->graphics->getBitmapData(bitmap, &width, &height, NULL, NULL, NULL);
+   assert(width == 336);
+   assert(height == 48);
+   g_pd->graphics->freeBitmap(bitmap);
+}
+
+int main(int argc, char **argv)
+{
+   (void)argc;
+   (void)argv;
+
+   g_pd = InitHostAPI("images");
+   TestFillRect();
+   TestDrawModes();
+   TestContext();
+   TestText();
+   TestLoadImages();
+   return 0;
+}
@@ -0,0 +1,276 @@
+// Host replacement for the subset of Playdate SDK's pd_api.h that is used
+// by this game.
+//
+// Type and member names match the SDK, so that game sources compile
+// unchanged with "-I host".  Only the members that we use are declared, and
+// the order of members does not match the SDK.  This header is never used
+// for device or simulator builds.
+
+#ifndef PD_API_H_
+#define PD_API_H_
+
+#include<stdarg.h>
+#include<stddef.h>
+#include<stdint.h>
+#include<stdlib.h>
+#include<string.h>
+
+#define LCD_COLUMNS  400
+#define LCD_ROWS     240
+#define LCD_ROWSIZE  52
+
+typedef struct LCDBitmap LCDBitmap;
+typedef struct LCDBitmapTable LCDBitmapTable;
+typedef struct LCDFont LCDFont;
+typedef struct FilePlayer FilePlayer;
+typedef struct SamplePlayer SamplePlayer;
+typedef struct AudioSample AudioSample;
+typedef struct PDMenuItem PDMenuItem;
+typedef void SDFile;
+
+typedef uint8_t LCDPattern[16];
+typedef uintptr_t LCDColor;
+
+typedef enum
+{
+   kColorBlack,
+   kColorWhite,
+   kColorClear,
+   kColorXOR
+} LCDSolidColor;
+
+typedef enum
+{
+   kBitmapUnflipped,
+   kBitmapFlippedX,
+   kBitmapFlippedY,
+   kBitmapFlippedXY
+} LCDBitmapFlip;
+
+typedef enum
+{
+   kDrawModeCopy,
+   kDrawModeWhiteTransparent,
+   kDrawModeBlackTransparent,
+   kDrawModeFillWhite,
+   kDrawModeFillBlack,
+   kDrawModeXOR,
+   kDrawModeNXOR,
+   kDrawModeInverted
+} LCDBitmapDrawMode;
+
+typedef enum
+{
+   kASCIIEncoding,
+   kUTF8Encoding,
+   k16BitLEEncoding
+} PDStringEncoding;
+
+typedef enum
+{
+   kButtonLeft = (1 << 0),
+   kButtonRight = (1 << 1),
+   kButtonUp = (1 << 2),
+   kButtonDown = (1 << 3),
+   kButtonB = (1 << 4),
+   kButtonA = (1 << 5)
+} PDButtons;
+
+typedef enum
+{
+   kNone = 0,
+   kAccelerometer = (1 << 0),
+   kAllPeripherals = 0xffff
+} PDPeripherals;
+
+typedef enum
+{
+   kEventInit,
+   kEventInitLua,
+   kEventLock,
+   kEventUnlock,
+   kEventPause,
+   kEventResume,
+   kEventTerminate,
+   kEventKeyPressed,
+   kEventKeyReleased,
+   kEventLowPower
+} PDSystemEvent;
+
+typedef enum
+{
+   kFileRead = (1 << 0),
+   kFileReadData = (1 << 1),
+   kFileWrite = (1 << 2),
+   kFileAppend = (2 << 2)
+} FileOptions;
+
+typedef enum
+{
+   kSound8bitMono = 0,
+   kSound8bitStereo = 1,
+   kSound16bitMono = 2,
+   kSound16bitStereo = 3,
+   kSoundADPCMMono = 4,
+   kSoundADPCMStereo = 5
+} SoundFormat;
+
+typedef int PDCallbackFunction(void *userdata);
+typedef void PDMenuItemCallbackFunction(void *userdata);
+
+struct playdate_graphics
+{
+   void (*clear)(LCDColor color);
+   LCDBitmapDrawMode (*setDrawMode)(LCDBitmapDrawMode mode);
+   void (*setFont)(LCDFont *font);
+   void (*pushContext)(LCDBitmap *target);
+   void (*popContext)(void);
+   void (*drawBitmap)(LCDBitmap *bitmap, int x, int y, LCDBitmapFlip flip);
+   void (*fillRect)(int x, int y, int width, int height, LCDColor color);
+   int (*drawText)(const void *text, size_t len, PDStringEncoding encoding,
+                   int x, int y);
+   LCDBitmap *(*newBitmap)(int width, int height, LCDColor bgcolor);
+   void (*freeBitmap)(LCDBitmap *bitmap);
+   LCDBitmap *(*loadBitmap)(const char *path, const char **outerr);
+   void (*getBitmapData)(LCDBitmap *bitmap, int *width, int *height,
+                         int *rowbytes, uint8_t **mask, uint8_t **data);
+   void (*clearBitmap)(LCDBitmap *bitmap, LCDColor bgcolor);
+   LCDBitmap *(*rotatedBitmap)(LCDBitmap *bitmap, float rotation,
+                               float xscale, float yscale, int *allocedSize);
+   LCDBitmapTable *(*newBitmapTable)(int count, int width, int height);
+   void (*freeBitmapTable)(LCDBitmapTable *table);
+   LCDBitmapTable *(*loadBitmapTable)(const char *path, const char **outerr);
+   LCDBitmap *(*getTableBitmap)(LCDBitmapTable *table, int idx);
+   LCDFont *(*loadFont)(const char *path, const char **outErr);
+   int (*getTextWidth)(LCDFont *font, const void *text, size_t len,
+                       PDStringEncoding encoding, int tracking);
+   uint8_t *(*getFrame)(void);
+   void (*markUpdatedRows)(int start, int end);
+   uint8_t (*getFontHeight)(LCDFont *font);
+   int (*setBitmapMask)(LCDBitmap *bitmap, LCDBitmap *mask);
+   LCDBitmap *(*getBitmapMask)(LCDBitmap *bitmap);
+   int (*getTextTracking)(void);
+   void (*getBitmapTableInfo)(LCDBitmapTable *table, int *count, int *width);
+   void (*drawRotatedBitmap)(LCDBitmap *bitmap, int x, int y, float rotation,
+                             float centerx, float centery,
+                             float xscale, float yscale);
+};
+
+struct playdate_sys
+{
+   void *(*realloc)(void *ptr, size_t size);
+   int (*formatString)(char **ret, const char *fmt, ...);
+   void (*logToConsole)(const char *fmt, ...);
+   void (*error)(const char *fmt, ...);
+   unsigned int (*getCurrentTimeMilliseconds)(void);
+   unsigned int (*getSecondsSinceEpoch)(unsigned int *milliseconds);
+   void (*drawFPS)(int x, int y);
+   void (*setUpdateCallback)(PDCallbackFunction *update, void *userdata);
+   void (*getButtonState)(PDButtons *current, PDButtons *pushed,
+                          PDButtons *released);
+   void (*setPeripheralsEnabled)(PDPeripherals mask);
+   void (*getAccelerometer)(float *outx, float *outy, float *outz);
+   float (*getCrankAngle)(void);
+   void (*setMenuImage)(LCDBitmap *bitmap, int xOffset);
+   PDMenuItem *(*addMenuItem)(const char *title,
+                              PDMenuItemCallbackFunction *callback,
+                              void *userdata);
+   PDMenuItem *(*addCheckmarkMenuItem)(const char *title, int value,
+                                       PDMenuItemCallbackFunction *callback,
+                                       void *userdata);
+   PDMenuItem *(*addOptionsMenuItem)(const char *title,
+                                     const char **optionTitles,
+                                     int optionsCount,
+                                     PDMenuItemCallbackFunction *f,
+                                     void *userdata);
+   int (*getMenuItemValue)(PDMenuItem *menuItem);
+   float (*getElapsedTime)(void);
+   void (*resetElapsedTime)(void);
+};
+
+struct playdate_display
+{
+   void (*setRefreshRate)(float rate);
+};
+
+typedef struct
+{
+   int isdir;
+   unsigned int size;
+   int m_year;
+   int m_month;
+   int m_day;
+   int m_hour;
+   int m_minute;
+   int m_second;
+} FileStat;
+
+// Values for seek, same as stdio.h.
+#ifndef SEEK_SET
+   #define SEEK_SET  0
+   #define SEEK_CUR  1
+   #define SEEK_END  2
+#endif
+
+struct playdate_file
+{
+   SDFile *(*open)(const char *name, FileOptions mode);
+   int (*close)(SDFile *file);
+   int (*read)(SDFile *file, void *buf, unsigned int len);
+   int (*write)(SDFile *file, const void *buf, unsigned int len);
+   int (*flush)(SDFile *file);
+   int (*seek)(SDFile *file, int pos, int whence);
+   int (*mkdir)(const char *path);
+   int (*stat)(const char *path, FileStat *stat);
+   const char *(*geterr)(void);
+};
+
+struct playdate_sound_fileplayer
+{
+   FilePlayer *(*newPlayer)(void);
+   void (*freePlayer)(FilePlayer *player);
+   int (*loadIntoPlayer)(FilePlayer *player, const char *path);
+   void (*setBufferLength)(FilePlayer *player, float bufferLen);
+   int (*play)(FilePlayer *player, int repeat);
+   int (*isPlaying)(FilePlayer *player);
+   void (*stop)(FilePlayer *player);
+   float (*getOffset)(FilePlayer *player);
+};
+
+struct playdate_sound_sample
+{
+   AudioSample *(*newSampleFromData)(uint8_t *data, SoundFormat format,
+                                     uint32_t sampleRate, int byteCount,
+                                     int shouldFreeData);
+   void (*freeSample)(AudioSample *sample);
+};
+
+struct playdate_sound_sampleplayer
+{
+   SamplePlayer *(*newPlayer)(void);
+   void (*freePlayer)(SamplePlayer *player);
+   void (*setSample)(SamplePlayer *player, AudioSample *sample);
+   int (*play)(SamplePlayer *player, int repeat, float rate);
+   int (*isPlaying)(SamplePlayer *player);
+   void (*stop)(SamplePlayer *player);
+   void (*setVolume)(SamplePlayer *player, float left, float right);
+};
+
+struct playdate_sound
+{
+   const struct playdate_sound_fileplayer *fileplayer;
+   const struct playdate_sound_sample *sample;
+   const struct playdate_sound_sampleplayer *sampleplayer;
+   uint32_t (*getCurrentTime)(void);
+};
+
+typedef struct PlaydateAPI
+{
+   const struct playdate_sys *system;
+   const struct playdate_file *file;
+   const struct playdate_graphics *graphics;
+   const struct playdate_sound *sound;
+   const struct playdate_display *display;
+} PlaydateAPI;
+
+#endif  // PD_API_H_
@@ -0,0 +1,144 @@
+// Measure rendering throughput on the host.
+//
+// Usage:
+//
+//    ./render_benchmark.exe [frames] [output.pbm]
+//
+// This runs world updates and DrawWorld with the host implementation of
+// Playdate API (see host_api.h), going through all platform styles and
+// launching meteors at a steady rate.  The slime is controlled by the bot
+// (see bot.h), so that the workload includes platform generation, springs,
+// and scrolling like a real game.
+//
+// Output includes a checksum of the final frame, which can be used to
+// check that a rendering change didn't change the output.  Optionally,
+// the final frame is written to a PBM file.
+//
+// Timings include the cost of the host rasterizer, which is not
+// representative of device performance.  This is mainly useful for
+// comparing relative costs between two versions of the game code.
+//
+// When built with "make PROFILE=1", section timers (see profile.h) are
+// also enabled, and per-section times are reported in the same format
+// as the device log at game over.
+
+#include<stdarg.h>
+#include<stdio.h>
+#include<stdlib.h>
+#include<time.h>
+#include"bot.h"
+#include"host_api.h"
+#include"hud.h"
+#include"images.h"
+#include"log_ring.h"
+#include"profile.h"
+#include"slime.h"
+#include"world.h"
+
+// Default number of frames to render.
+#define DEFAULT_FRAMES  3000
+
+static World g_world;
+
+// Get current time in microseconds.
+static int64_t GetMicroseconds(void)
+{
+   struct timespec now;
+   clock_gettime(CLOCK_MONOTONIC, &now);
+   return (int64_t)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
+
+// Print log messages to stderr.
+static void Log(const char *format, ...)
+{
+   va_list args;
+   va_start(args, format);
+   vfprintf(stderr, format, args);
+   va_end(args);
+   fputc('\n', stderr);
+}
+
+int main(int argc, char **argv)
+{
+   const int frames = argc > 1 ? atoi(argv[1]) : DEFAULT_FRAMES;
+   if( frames <= 0 )
+   {
+      fprintf(stderr, "%s [frames] [output.pbm]\n", *argv);
+      return 1;
+   }
+
+   PlaydateAPI *pd = InitHostAPI("images");
+   const char *error;
+   LoadHud(pd, pd->graphics->loadFont("", &error));
+   OpenImages(pd);
+   LoadSlime(pd);
+   LoadWorld(pd);
+   while( !LoadPendingWorldImages(pd) )
+      ;
+
+   srand(1);
+   ResetWorld(&g_world);
+   const BotConfig config = {100, 100, 0};
+   Bot bot;
+   ResetBot(&bot, &config, 1);
+
+   #if ENABLE_PROFILE
+      SetProfileClock(pd->system->getElapsedTime,
+                      pd->system->resetElapsedTime);
+   #endif
+
+   int64_t update_time = 0, draw_time = 0;
+   for(int frame = 0; frame < frames; frame++)
+   {
+      #if ENABLE_PROFILE
+         BeginProfileFrame();
+      #endif
+
+      // Advance through all styles and meteor beats over the course of
+      // the benchmark, similar to how the song would.
+      const int phase = frame * 4 / frames;
+      g_world.platform_style = (PlatformStyle)phase;
+      g_world.beat = frame * MAX_METEORS / frames;
+
+      const BotInput input = UpdateBot(&bot, &g_world);
+      g_world.slime.a = input.angle;
+      if( input.jump )
+         JumpSlime(&(g_world.slime));
+
+      const int64_t start = GetMicroseconds();
+      UpdateWorld(&g_world);
+      UpdateWorldImages(&g_world,
+                        (PlatformStyle)(phase < 3 ? phase + 1 : 3),
+                        pd);
+      const int64_t middle = GetMicroseconds();
+      DrawWorld(&g_world, pd);
+      const int64_t end = GetMicroseconds();
+      update_time += middle - start;
+      draw_time += end - middle;
+   }
+
+   printf("%d frames: update %.1f us/frame, draw %.1f us/frame, "
+          "height %d, checksum %08x\n",
+          frames,
+          (double)update_time / frames,
+          (double)draw_time / frames,
+          (-g_world.slime.peak) >> SLIME_FRACTION_BITS,
+          GetHostFrameChecksum());
+
+   ReportWorldImages();
+   ReportImageLoads();
+   FlushLogRing(Log, LOG_RING_SIZE);
+   #if ENABLE_PROFILE
+      // Include the last frame, which BeginProfileFrame would otherwise
+      // accumulate at the start of the next one.
+      BeginProfileFrame();
+      ReportProfile(Log);
+   #endif
+
+   if( argc > 2 && WriteHostFrame(argv[2]) != 0 )
+   {
+      fprintf(stderr, "Error writing %s\n", argv[2]);
+      return 1;
+   }
+   return 0;
+}
@@ -0,0 +1,84 @@
+#include"replay.h"
+#include<stdio.h>
+
+// Get input for a frame.
+BotInput GetReplayInput(const Replay *replay, int frame)
+{
+   if( frame >= 0 && frame < replay->frame_count )
+      return replay->input[frame];
+
+   BotInput input;
+   input.angle = 0;
+   input.jump = 0;
+   return input;
+}
+
+// Load replay from file.
+int LoadReplay(const char *path, Replay *replay)
+{
+   FILE *infile = fopen(path, "rb");
+   if( infile == NULL )
+      return 1;
+
+   int have_seed = 0;
+   replay->frame_count = 0;
+   char line[64];
+   while( fgets(line, sizeof(line), infile) != NULL )
+   {
+      if( *line == '#' || *line == '\n' )
+         continue;
+      if( !have_seed )
+      {
+         if( sscanf(line, "seed %u", &(replay->seed)) != 1 )
+            break;
+         have_seed = 1;
+         continue;
+      }
+
+      unsigned int angle;
+      int jump, count = 1;
+      if( sscanf(line, "%u %d %d", &angle, &jump, &count) < 2 ||
+          angle >= 360 || count <= 0 ||
+          count > SIMULATION_FRAMES - replay->frame_count )
+      {
+         fclose(infile);
+         return 1;
+      }
+      for(; count > 0; count--)
+      {
+         replay->input[replay->frame_count].angle = angle;
+         replay->input[replay->frame_count].jump = jump != 0;
+         replay->frame_count++;
+      }
+   }
+   const int error = ferror(infile) || !feof(infile) || !have_seed;
+   fclose(infile);
+   return error;
+}
+
+// Save replay to file.
+int SaveReplay(const char *path, const Replay *replay)
+{
+   FILE *outfile = fopen(path, "wb");
+   if( outfile == NULL )
+      return 1;
+
+   fprintf(outfile, "seed %u\n", replay->seed);
+   for(int i = 0; i < replay->frame_count;)
+   {
+      const BotInput *input = &(replay->input[i]);
+      int count = 1;
+      while( i + count < replay->frame_count &&
+             replay->input[i + count].angle == input->angle &&
+             replay->input[i + count].jump == input->jump )
+      {
+         count++;
+      }
+      if( count == 1 )
+         fprintf(outfile, "%u %d\n", input->angle, input->jump);
+      else
+         fprintf(outfile, "%u %d %d\n", input->angle, input->jump, count);
+      i += count;
+   }
+   return fclose(outfile) != 0;
+}
@@ -0,0 +1,44 @@
+// Library for saving and loading recorded game inputs.
+//
+// A replay is a seed plus one input per frame, which is enough to play a
+// game out the same way again with StepSimulation (see simulation.h), or
+// on the device with playback.h.
+// Replays are stored as text:
+//
+//    seed 12345
+//    350 1 2
+//    0 0
+//    ...
+//
+// where each line after the seed is the crank angle and jump button state
+// for one frame, optionally followed by the number of consecutive frames
+// with the same input.  Lines starting with "#" are comments.
+
+#ifndef REPLAY_H_
+#define REPLAY_H_
+
+#include"bot.h"
+#include"simulation.h"
+
+typedef struct
+{
+   // Seed for ResetSimulation.
+   unsigned int seed;
+
+   // Number of recorded frames.  Frames after the last recorded frame use
+   // default inputs (angle 0, jump button not held).
+   int frame_count;
+
+   BotInput input[SIMULATION_FRAMES];
+} Replay;
+
+// Get input for a frame.
+BotInput GetReplayInput(const Replay *replay, int frame);
+
+// Load replay from file.  Returns 0 on success.
+int LoadReplay(const char *path, Replay *replay);
+
+// Save replay to file.  Returns 0 on success.
+int SaveReplay(const char *path, const Replay *replay);
+
+#endif  // REPLAY_H_
@@ -0,0 +1,64 @@
+#include"simulation.h"
+#include<stdlib.h>
+#include"common.h"
+
+// Reset world for a new game.
+void ResetSimulation(World *world, unsigned int seed)
+{
+   srand(seed);
+   ResetWorld(world);
+}
+
+// Get song beat for a frame.
+static int GetFrameBeat(int frame)
+{
+   return GetSongBeatAtTime((uint32_t)frame * (SAMPLE_RATE / SIMULATION_RATE));
+}
+
+// Run a single frame.
+int StepSimulation(World *world, int frame, unsigned int angle, int jump)
+{
+   const int beat = GetFrameBeat(frame);
+   if( (beat >> 16) > kPlatformSpace )
+      return 0;
+   world->beat = beat & 0xffff;
+   world->platform_style = (PlatformStyle)(beat >> 16);
+
+   world->slime.a = angle;
+   if( jump )
+      JumpSlime(&(world->slime));
+   UpdateWorld(world);
+   return 1;
+}
+
+// Get song phase for a frame.
+int GetSimulationPhase(int frame)
+{
+   return GetFrameBeat(frame) >> 16;
+}
+
+// Get platform under slime.
+int GetRestingPlatform(const World *world)
+{
+   if( world->slime.in_flight_time != 0 )
+      return -1;
+
+   // Platform cursor is updated before landing, so the resting platform is
+   // at or near the cursor.
+   const int y = world->slime.y >> SLIME_FRACTION_BITS;
+   for(int i = world->platform_cursor; i >= 0; i--)
+   {
+      if( world->platform[i].y == y )
+         return i;
+      if( world->platform[i].y > y )
+         break;
+   }
+   for(int i = world->platform_cursor + 1; i < world->platform_limit; i++)
+   {
+      if( world->platform[i].y == y )
+         return i;
+      if( world->platform[i].y < y )
+         break;
+   }
+   return -1;
+}
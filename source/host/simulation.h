@@ -0,0 +1,35 @@
+// Library for running games without display or audio on the host.
+//
+// This applies inputs and song beats to World the same way as
+// UpdateGameInProgress in main.c, with one world update per frame.  Song
+// position is derived from frame count (see GetSongBeatAtTime) instead of
+// the audio clock, so a game with the same seed and inputs always plays
+// out the same way.
+
+#ifndef SIMULATION_H_
+#define SIMULATION_H_
+
+#include"bgm.h"
+#include"refresh.h"
+#include"world.h"
+
+// Number of frames in a full game.
+#define SIMULATION_FRAMES  ((int)(SONG_LENGTH / (SAMPLE_RATE / SIMULATION_RATE)))
+
+// Reset world for a new game.  World generation uses rand(), so this also
+// seeds the random number generator.
+void ResetSimulation(World *world, unsigned int seed);
+
+// Run a single frame with the given inputs.  Returns 0 if the song has
+// ended before this frame, in which case the world is not updated.
+int StepSimulation(World *world, int frame, unsigned int angle, int jump);
+
+// Get song phase for a frame, in the range of [0..4], where 4 means the
+// song has ended.
+int GetSimulationPhase(int frame);
+
+// Get index of the platform that the slime is resting on, or -1 if slime
+// is in flight.
+int GetRestingPlatform(const World *world);
+
+#endif  // SIMULATION_H_
@@ -0,0 +1,307 @@
+// Measure individual world update functions on the host.
+//
+// Usage:
+//
+//    ./world_benchmark.exe [repetitions] [results.txt]
+//
+// render_benchmark measures whole frames, which tells us whether a frame
+// got slower but not which function is responsible.  This benchmark calls
+// the hot functions in world.c directly on prepared worlds:
+//
+//    cursor_*      AdjustPlatformCursor moving by one platform or by most
+//                  of the world.
+//    chain_*       AppendSimpleChain with parameters for each style.
+//    shape_*       AppendPredefinedShape with parameters for each style.
+//    sort_*        SortPlatformSuffix with a platform already in order, and
+//                  with a diversion that needs to be moved by one slot.
+//    meteor_*      SpawnMeteors and AnimateMeteors with MAX_METEORS live.
+//    background    UpdateBackgroundColor.
+//    landing       MoveSlime with a falling slime landing on a platform.
+//
+// These functions are static, so this file includes world.c directly
+// instead of linking against world.o.
+//
+// Each benchmark runs a number of warm-up batches that are discarded,
+// followed by the requested number of timed batches.  Each batch calls the
+// function enough times to make timer overhead negligible, and the time
+// per call for each batch is one sample.  Output is the median and 99th
+// percentile of those samples, printed to stdout and optionally written
+// as tab-separated values to results.txt for comparing between runs.
+//
+// As with render_benchmark, absolute times are not representative of
+// device performance.
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<time.h>
+#include"world.c"
+
+// Default number of timed batches per benchmark.
+#define DEFAULT_REPETITIONS   200
+
+// Number of untimed batches per benchmark.
+#define WARMUP_BATCHES        20
+
+// Number of platforms in prepared worlds.  This is roughly the number of
+// platforms generated by the time the slime reaches the space phase.
+#define WORLD_PLATFORMS       512
+
+typedef struct
+{
+   const char *name;
+
+   // Prepare g_world before each batch.  Not included in timing.
+   void (*setup)(void);
+
+   // Function to be measured.
+   void (*run)(void);
+
+   // Number of run calls per batch.
+   int iterations;
+} Benchmark;
+
+// World prepared by BuildWorld, copied to g_world before each batch.
+static World g_prepared_world;
+static World g_world;
+
+// Alternating state for cursor benchmarks.
+static int g_cursor_toggle;
+
+// Vertical offset of appended platforms in sort benchmarks.
+static int g_sort_offset;
+
+// Platform index for landing benchmark.
+static int g_landing_platform;
+
+// Get current time in nanoseconds.
+static int64_t GetNanoseconds(void)
+{
+   struct timespec now;
+   clock_gettime(CLOCK_MONOTONIC, &now);
+   return (int64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+// Build a world with WORLD_PLATFORMS platforms in g_prepared_world.  Styles
+// are changed along the way in the same order as a real game, so that the
+// world contains diversions, springs, and predefined shapes.
+static void BuildWorld(void)
+{
+   World *world = &g_prepared_world;
+   srand(1);
+   ResetWorld(world);
+   for(int style = kPlatformTrees; style <= kPlatformSpace; style++)
+   {
+      world->platform_style = (PlatformStyle)style;
+      const int limit = WORLD_PLATFORMS * (style + 1) / 4;
+      while( world->platform_limit < limit )
+      {
+         world->scroll_offset_y = SCREEN_HEIGHT - GetWorldCeiling(world);
+         GeneratePlatforms(world);
+      }
+   }
+   world->scroll_offset_y = 0;
+}
+
+// Copy prepared world to g_world, with slime and camera positioned near
+// the middle of the world.
+static void SetupPreparedWorld(void)
+{
+   memcpy(&g_world, &g_prepared_world, sizeof(World));
+   srand(1);
+   const Platform *middle = &(g_world.platform[g_world.platform_limit / 2]);
+   g_world.slime.x = ((middle->x + GetPlatformWidth(middle->type) / 2) %
+                      SCREEN_WIDTH) << SLIME_FRACTION_BITS;
+   g_world.slime.y = middle->y << SLIME_FRACTION_BITS;
+   g_world.platform_cursor = g_world.platform_limit / 2;
+   g_world.scroll_offset_y = 3 * SCREEN_HEIGHT / 4 - middle->y;
+   g_cursor_toggle = 0;
+}
+
+// Reset g_world to the starting floor.
+static void SetupEmptyWorld(void)
+{
+   srand(1);
+   ResetWorld(&g_world);
+}
+
+// AdjustPlatformCursor benchmarks.
+static void RunCursorSmall(void)
+{
+   const int i = g_world.platform_limit / 2 + (g_cursor_toggle ^= 1);
+   AdjustPlatformCursor(&g_world, g_world.platform[i].y);
+}
+
+static void RunCursorLarge(void)
+{
+   const int i = (g_cursor_toggle ^= 1) != 0 ? 1 : g_world.platform_limit - 2;
+   AdjustPlatformCursor(&g_world, g_world.platform[i].y);
+}
+
+// Generator benchmarks, with the same parameters as GeneratePlatforms.
+static void RunChainTrees(void) { AppendSimpleChain(&g_world, 18, 6); }
+static void RunChainRocks(void) { AppendSimpleChain(&g_world, 12, 5); }
+static void RunChainClouds(void) { AppendSimpleChain(&g_world, 6, 4); }
+static void RunChainSpace(void) { AppendSimpleChain(&g_world, 0, 0); }
+static void RunShapeRocks(void) { AppendPredefinedShape(&g_world, 12); }
+static void RunShapeClouds(void) { AppendPredefinedShape(&g_world, 6); }
+
+// SortPlatformSuffix benchmarks.  Each call appends a platform relative to
+// the current highest platform, either above it, or slightly below it like
+// the diversions added by AppendSimpleChain.
+static void SetupSortNone(void)
+{
+   SetupPreparedWorld();
+   g_sort_offset = -1;
+}
+
+static void SetupSortDiversion(void)
+{
+   SetupPreparedWorld();
+   g_sort_offset = 1;
+}
+
+static void RunSort(void)
+{
+   const int limit = g_world.platform_limit;
+   const Platform *top = &(g_world.platform[limit - 1]);
+   Platform *new_platform = &(g_world.platform[limit]);
+   *new_platform = *top;
+   new_platform->y = top->y + g_sort_offset;
+   g_world.platform_limit++;
+   SortPlatformSuffix(&g_world);
+}
+
+// Meteor benchmarks.
+static void SetupMeteors(void)
+{
+   SetupPreparedWorld();
+   g_world.disable_meteors = 0;
+   g_world.beat = MAX_METEORS;
+   g_world.meteor_start = 0;
+   g_world.meteor_end = 0;
+   SpawnMeteors(&g_world);
+}
+
+static void RunSpawnMeteors(void)
+{
+   g_world.meteor_end = 0;
+   SpawnMeteors(&g_world);
+}
+
+static void RunAnimateMeteors(void)
+{
+   g_world.meteor_start = 0;
+   AnimateMeteors(&g_world);
+}
+
+// UpdateBackgroundColor benchmark.
+static void RunBackground(void)
+{
+   UpdateBackgroundColor(&g_world);
+}
+
+// MoveSlime benchmark.  Each call drops the slime from just above a
+// platform so that it lands on that platform.
+static void SetupLanding(void)
+{
+   SetupPreparedWorld();
+   g_landing_platform = g_world.platform_limit / 2;
+}
+
+static void RunLanding(void)
+{
+   const Platform *target = &(g_world.platform[g_landing_platform]);
+   Slime *slime = &(g_world.slime);
+   slime->x = ((target->x + GetPlatformWidth(target->type) / 2) %
+               SCREEN_WIDTH) << SLIME_FRACTION_BITS;
+   slime->y = (target->y - 2) << SLIME_FRACTION_BITS;
+   slime->vx = 0;
+   slime->vy = 4 << SLIME_FRACTION_BITS;
+   slime->in_flight_time = 1;
+   MoveSlime(&g_world);
+}
+
+static const Benchmark kBenchmarks[] =
+{
+   {"cursor_small", SetupPreparedWorld, RunCursorSmall, 1000},
+   {"cursor_large", SetupPreparedWorld, RunCursorLarge, 100},
+   {"chain_trees", SetupEmptyWorld, RunChainTrees, 100},
+   {"chain_rocks", SetupEmptyWorld, RunChainRocks, 100},
+   {"chain_clouds", SetupEmptyWorld, RunChainClouds, 100},
+   {"chain_space", SetupEmptyWorld, RunChainSpace, 100},
+   {"shape_rocks", SetupEmptyWorld, RunShapeRocks, 100},
+   {"shape_clouds", SetupEmptyWorld, RunShapeClouds, 100},
+   {"sort_none", SetupSortNone, RunSort, 100},
+   {"sort_diversion", SetupSortDiversion, RunSort, 100},
+   {"meteor_spawn", SetupMeteors, RunSpawnMeteors, 100},
+   {"meteor_animate", SetupMeteors, RunAnimateMeteors, 100},
+   {"background", SetupPreparedWorld, RunBackground, 100},
+   {"landing", SetupLanding, RunLanding, 1000},
+};
+
+// Comparison function for sorting samples.
+static int CompareSamples(const void *a, const void *b)
+{
+   const double x = *(const double*)a;
+   const double y = *(const double*)b;
+   return x < y ? -1 : x > y ? 1 : 0;
+}
+
+// Run a single batch, returning time per call in nanoseconds.
+static double RunBatch(const Benchmark *benchmark)
+{
+   benchmark->setup();
+   const int64_t start = GetNanoseconds();
+   for(int i = 0; i < benchmark->iterations; i++)
+      benchmark->run();
+   return (double)(GetNanoseconds() - start) / benchmark->iterations;
+}
+
+int main(int argc, char **argv)
+{
+   const int repetitions = argc > 1 ? atoi(argv[1]) : DEFAULT_REPETITIONS;
+   if( repetitions <= 0 )
+   {
+      fprintf(stderr, "%s [repetitions] [results.txt]\n", *argv);
+      return 1;
+   }
+   FILE *outfile = NULL;
+   if( argc > 2 && (outfile = fopen(argv[2], "wb")) == NULL )
+   {
+      fprintf(stderr, "Error writing %s\n", argv[2]);
+      return 1;
+   }
+
+   BuildWorld();
+   printf("world: platform_limit %d, spring_limit %d\n",
+          g_prepared_world.platform_limit, g_prepared_world.spring_limit);
+   if( outfile != NULL )
+      fprintf(outfile, "# name\tmedian_ns\tp99_ns\n");
+
+   double *samples = (double*)malloc(repetitions * sizeof(double));
+   for(size_t b = 0; b < sizeof(kBenchmarks) / sizeof(kBenchmarks[0]); b++)
+   {
+      const Benchmark *benchmark = &kBenchmarks[b];
+      for(int i = 0; i < WARMUP_BATCHES; i++)
+         RunBatch(benchmark);
+      for(int i = 0; i < repetitions; i++)
+         samples[i] = RunBatch(benchmark);
+
+      qsort(samples, repetitions, sizeof(double), CompareSamples);
+      const double median = samples[repetitions / 2];
+      const double p99 = samples[(repetitions - 1) * 99 / 100];
+      printf("%-16s median %10.1f ns, p99 %10.1f ns\n",
+             benchmark->name, median, p99);
+      if( outfile != NULL )
+         fprintf(outfile, "%s\t%.1f\t%.1f\n", benchmark->name, median, p99);
+   }
+   free(samples);
+
+   if( outfile != NULL && fclose(outfile) != 0 )
+   {
+      fprintf(stderr, "Error writing %s\n", argv[2]);
+      return 1;
+   }
+   return 0;
+}
@@ -0,0 +1,250 @@
+// Search for the game inputs that produce the most expensive single frame.
+//
+// Usage:
+//
+//    ./worst_frame.exe [restarts] [iterations] [seed] [replay.txt]
+//
+// Defaults are restarts=10, iterations=200, seed=1.
+//
+// Frame cost is a weighted sum of work counters (see work_count.h) for a
+// single world update.  Counts are deterministic, so unlike timings, a
+// frame that is expensive here is expensive on every run.  Drawing is not
+// simulated, so bitmap draws are not part of the cost.
+//
+// Each restart plays a game with a consecutive seed starting from {seed},
+// using the bot with random aggressiveness and fall rate, and records the
+// inputs.  It then does hill climbing over that recording: each iteration
+// either overwrites a random span of inputs before the current worst
+// frame with a different angle and button state, or replaces the seed
+// while keeping the inputs.  Changes that don't make the worst frame
+// cheaper are kept.
+//
+// Output shows the worst frame of each restart and a breakdown of the
+// overall worst frame.  If a file name is given, inputs up to the worst
+// frame are written there as a replay (see replay.h), which can be played
+// back with farm.exe, or on the device by copying it to the data folder as
+// "replay.txt" in a "make REPLAY=1" build (see playback.h).
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include"bot.h"
+#include"replay.h"
+#include"simulation.h"
+#include"work_count.h"
+
+// Maximum number of frames changed by a single input perturbation.
+#define MAX_SPAN_FRAMES    30
+
+// Probability of changing seed instead of inputs, in 1/256 units.
+#define SEED_CHANGE_RATE   32
+
+// Approximate cost of each unit of work in nanoseconds, from a least
+// squares fit of host frame times against work counts over 10 bot games.
+// Only the relative sizes matter.  Without weights, the worst frame is
+// always near the end of the game, since AnimatePlatforms visits every
+// platform and platform count only increases.
+static const uint32_t kWorkWeight[kWorkCounterCount] =
+{
+   325,  // kWorkGenerate
+   0,    // kWorkGhostStep, included in kWorkGenerate
+   60,   // kWorkSortMove
+   3,    // kWorkCursorStep
+   9,    // kWorkMeteorScan
+   1,    // kWorkPlatformScan
+   2,    // kWorkSpringScan
+   2,    // kWorkBackgroundScan
+   0,    // kWorkMemoryBytes, included in kWorkSortMove and kWorkBackgroundScan
+   0,    // kWorkBlit
+};
+
+// First frame to consider.  The first world update generates a full
+// screen of platforms for every seed, so it's always the most expensive
+// frame, but it happens during the transition from title screen.
+#define FIRST_FRAME  1
+
+// Worst frame found in a game.
+typedef struct
+{
+   int frame;
+   uint32_t cost;
+   uint32_t work_count[kWorkCounterCount];
+
+   // World state after the worst frame.
+   int platform_limit;
+   int platform_cursor;
+   int spring_limit;
+   int slime_y;
+} WorstFrame;
+
+static World g_world;
+
+// Random number generator for search decisions, separate from rand() so
+// that it doesn't interfere with world generation.
+static uint32_t g_search_random = 1;
+
+// Get a random number in the range of [0..max].
+static int SearchRandom(int max)
+{
+   g_search_random ^= g_search_random << 13;
+   g_search_random ^= g_search_random >> 17;
+   g_search_random ^= g_search_random << 5;
+   return (int)(g_search_random % (uint32_t)(max + 1));
+}
+
+// Get weighted total of work counters.
+static uint32_t GetFrameCost(void)
+{
+   uint32_t cost = 0;
+   for(int i = 0; i < kWorkCounterCount; i++)
+      cost += g_work_count[i] * kWorkWeight[i];
+   return cost;
+}
+
+// Play a game with replay inputs and find the most expensive frame.
+// Among frames with equal cost, the first one is kept.
+static void EvaluateReplay(const Replay *replay, WorstFrame *worst)
+{
+   ResetSimulation(&g_world, replay->seed);
+   worst->frame = 0;
+   worst->cost = 0;
+   for(int frame = 0;; frame++)
+   {
+      const BotInput input = GetReplayInput(replay, frame);
+      ResetWorkCount();
+      if( !StepSimulation(&g_world, frame, input.angle, input.jump) )
+         break;
+
+      const uint32_t cost = GetFrameCost();
+      if( frame >= FIRST_FRAME && worst->cost < cost )
+      {
+         worst->frame = frame;
+         worst->cost = cost;
+         memcpy(worst->work_count, g_work_count, sizeof(g_work_count));
+         worst->platform_limit = g_world.platform_limit;
+         worst->platform_cursor = g_world.platform_cursor;
+         worst->spring_limit = g_world.spring_limit;
+         worst->slime_y = g_world.slime.y >> SLIME_FRACTION_BITS;
+      }
+   }
+}
+
+// Play a game with the bot and record its inputs.
+static void RecordBotGame(unsigned int seed, Replay *replay)
+{
+   BotConfig config;
+   config.skill = 100;
+   config.aggressiveness = SearchRandom(100);
+   config.fall_rate = SearchRandom(30);
+   Bot bot;
+   ResetBot(&bot, &config, seed);
+   ResetSimulation(&g_world, seed);
+
+   replay->seed = seed;
+   replay->frame_count = 0;
+   for(int frame = 0; frame < SIMULATION_FRAMES; frame++)
+   {
+      const BotInput input = UpdateBot(&bot, &g_world);
+      if( !StepSimulation(&g_world, frame, input.angle, input.jump) )
+         break;
+      replay->input[replay->frame_count++] = input;
+   }
+}
+
+// Change a random part of the replay.
+static void PerturbReplay(Replay *replay, int worst_frame)
+{
+   if( SearchRandom(255) < SEED_CHANGE_RATE )
+   {
+      replay->seed = (unsigned int)SearchRandom(1000000);
+      return;
+   }
+
+   // Overwrite a span of inputs that ends before the worst frame, so that
+   // the change can affect it.
+   const int start = SearchRandom(worst_frame);
+   const int end = start + 1 + SearchRandom(MAX_SPAN_FRAMES - 1);
+   const unsigned int angle = (unsigned int)(SearchRandom(160) + 280) % 360;
+   const int jump = SearchRandom(1);
+   for(int i = start; i < end && i < replay->frame_count; i++)
+   {
+      replay->input[i].angle = angle;
+      replay->input[i].jump = jump;
+   }
+}
+
+int main(int argc, char **argv)
+{
+   const int restarts = argc > 1 ? atoi(argv[1]) : 10;
+   const int iterations = argc > 2 ? atoi(argv[2]) : 200;
+   const unsigned int first_seed = argc > 3 ? (unsigned int)atoi(argv[3]) : 1;
+   if( restarts <= 0 || iterations < 0 )
+   {
+      fprintf(stderr, "%s [restarts] [iterations] [seed] [replay.txt]\n",
+              *argv);
+      return 1;
+   }
+   g_search_random = first_seed != 0 ? first_seed : 1;
+
+   static Replay best_replay, current, candidate;
+   WorstFrame best;
+   memset(&best, 0, sizeof(best));
+   for(int r = 0; r < restarts; r++)
+   {
+      RecordBotGame(first_seed + r, &current);
+      WorstFrame current_worst;
+      EvaluateReplay(&current, &current_worst);
+      const uint32_t initial_cost = current_worst.cost;
+
+      for(int i = 0; i < iterations; i++)
+      {
+         candidate = current;
+         PerturbReplay(&candidate, current_worst.frame);
+         WorstFrame candidate_worst;
+         EvaluateReplay(&candidate, &candidate_worst);
+         if( candidate_worst.cost >= current_worst.cost )
+         {
+            current = candidate;
+            current_worst = candidate_worst;
+         }
+      }
+      printf("restart %d: seed %u, frame %d, cost %u (initial %u)\n",
+             r, current.seed, current_worst.frame, current_worst.cost,
+             initial_cost);
+
+      if( best.cost < current_worst.cost )
+      {
+         best = current_worst;
+         best_replay = current;
+      }
+   }
+
+   printf("worst frame: seed %u, frame %d, cost %u\n",
+          best_replay.seed, best.frame, best.cost);
+   for(int i = 0; i < kWorkCounterCount; i++)
+   {
+      if( i != kWorkBlit )
+      {
+         printf("   %s: %u\n",
+                GetWorkCounterName((WorkCounter)i), best.work_count[i]);
+      }
+   }
+   printf("   platform_limit=%d, platform_cursor=%d, spring_limit=%d, "
+          "slime_y=%d\n",
+          best.platform_limit, best.platform_cursor, best.spring_limit,
+          best.slime_y);
+
+   if( argc > 4 )
+   {
+      // Only inputs up to the worst frame are needed to reproduce it.
+      best_replay.frame_count = best.frame + 1;
+      if( SaveReplay(argv[4], &best_replay) != 0 )
+      {
+         fprintf(stderr, "Error writing %s\n", argv[4]);
+         return 1;
+      }
+      printf("Wrote %s, run \"./farm.exe 1 1 %u %s\" to play it back\n",
+             argv[4], best_replay.seed, argv[4]);
+   }
+   return 0;
+}
@@ -0,0 +1,143 @@
+#!/usr/bin/perl -w
+# Report size and placement of hot functions in a device build.
+#
+# Usage:
+#
+#    perl hot_set_report.pl {link_order.ld} {game.map}
+#
+# Hot functions are the ones between __hot_text_start and __hot_text_end
+# in link_order.ld (see generate_link_order.pl).  Their addresses and
+# sizes are read from the linker map, and we report how many instruction
+# cache lines they occupy, and how much of the instruction cache is needed
+# to hold all of them.
+
+use strict;
+
+# Cortex-M7 instruction cache parameters for STM32F7.
+use constant ICACHE_BYTES => 4096;
+use constant ICACHE_LINE_BYTES => 32;
+
+if( $#ARGV != 1 )
+{
+   die "$0 {link_order.ld} {game.map}\n";
+}
+my ($order_file, $map_file) = @ARGV;
+
+# Load list of hot functions.
+my @hot = ();
+open my $order, "<$order_file" or die "$order_file: $!\n";
+my $in_hot_set = 0;
+while( my $line = <$order> )
+{
+   if( $line =~ /^__hot_text_start\b/ )
+   {
+      $in_hot_set = 1;
+   }
+   elsif( $line =~ /^__hot_text_end\b/ )
+   {
+      $in_hot_set = 0;
+   }
+   elsif( $in_hot_set && $line =~ /^\*\(\.text\.(\w+)\s/ )
+   {
+      push @hot, $1;
+   }
+}
+close $order;
+scalar @hot > 0 or die "$order_file: no hot functions\n";
+
+# Load function sections from linker map.  Each input section is listed
+# either on a single line:
+#
+#     .text.Name     0x00001234       0x40 file.o
+#
+# or on two lines if the section name is long:
+#
+#     .text.LongName
+#                    0x00001234       0x40 file.o
+my %address = ();
+my %size = ();
+my %symbol = ();
+open my $map, "<$map_file" or die "$map_file: $!\n";
+my $in_memory_map = 0;
+my $pending_name = undef;
+while( my $line = <$map> )
+{
+   if( !$in_memory_map )
+   {
+      $in_memory_map = 1 if $line =~ /^Linker script and memory map/;
+      next;
+   }
+   last if $line =~ /^Cross Reference Table/;
+
+   my ($name, $start, $length);
+   if( $line =~ /^ \.text\.(\S+)\s+0x([[:xdigit:]]+)\s+0x([[:xdigit:]]+)\s/ )
+   {
+      ($name, $start, $length) = ($1, hex($2), hex($3));
+   }
+   elsif( $line =~ /^ \.text\.(\S+)$/ )
+   {
+      $pending_name = $1;
+      next;
+   }
+   elsif( defined($pending_name) &&
+          $line =~ /^\s+0x([[:xdigit:]]+)\s+0x([[:xdigit:]]+)\s/ )
+   {
+      ($name, $start, $length) = ($pending_name, hex($1), hex($2));
+   }
+   elsif( $line =~ /^\s+0x([[:xdigit:]]+)\s+(__hot_text_(?:start|end)) = \./ )
+   {
+      $symbol{$2} = hex($1);
+   }
+   $pending_name = undef;
+   next unless defined $name;
+
+   # Merge clones and LTO-renamed copies with the original function.
+   $name =~ s/\..*$//;
+   if( !exists $address{$name} || $address{$name} > $start )
+   {
+      $address{$name} = $start;
+   }
+   $size{$name} += $length;
+}
+close $map;
+exists $symbol{"__hot_text_start"} && exists $symbol{"__hot_text_end"}
+   or die "$map_file: missing __hot_text_start or __hot_text_end\n";
+my $hot_start = $symbol{"__hot_text_start"};
+my $hot_end = $symbol{"__hot_text_end"};
+
+# List hot functions in address order, and count cache lines touched.
+my @found = sort {$address{$a} <=> $address{$b}}
+            grep {exists $address{$_} && $size{$_} > 0} @hot;
+my @missing = grep {!exists $address{$_} || $size{$_} == 0} @hot;
+my %lines = ();
+my $total_size = 0;
+print "Hot functions:\n";
+foreach my $name (@found)
+{
+   my $start = $address{$name};
+   my $end = $start + $size{$name};
+   my $placement = ($start >= $hot_start && $end <= $hot_end) ? "" :
+                   "  (outside hot range)";
+   printf "   0x%08x %6d  %s%s\n", $start, $size{$name}, $name, $placement;
+   $total_size += $size{$name};
+   for(my $line = int($start / ICACHE_LINE_BYTES);
+       $line * ICACHE_LINE_BYTES < $end;
+       $line++)
+   {
+      $lines{$line} = 1;
+   }
+}
+if( scalar @missing > 0 )
+{
+   print "Not found (inlined or removed): ", (join " ", @missing), "\n";
+}
+
+my $line_count = scalar keys %lines;
+my $span = $hot_end - $hot_start;
+printf "Hot set: %d functions, %d bytes, %d cache lines (%d bytes)\n",
+       scalar @found, $total_size, $line_count,
+       $line_count * ICACHE_LINE_BYTES;
+printf "Hot range: 0x%08x..0x%08x, %d bytes\n", $hot_start, $hot_end, $span;
+printf "Instruction cache: %d bytes, hot set uses %d%%\n",
+       ICACHE_BYTES,
+       int($line_count * ICACHE_LINE_BYTES * 100 / ICACHE_BYTES + 0.5);
@@ -0,0 +1,97 @@
+#!/bin/bash
+
+if [[ $# -ne 1 ]]; then
+   echo "$0 {hot_set_report.pl}"
+   exit 1
+fi
+TOOL=$1
+
+set -euo pipefail
+ORDER=$(mktemp)
+MAP=$(mktemp)
+EXPECTED_OUTPUT=$(mktemp)
+ACTUAL_OUTPUT=$(mktemp)
+
+function die
+{
+   echo "$1"
+   rm -f "$ORDER" "$MAP" "$EXPECTED_OUTPUT" "$ACTUAL_OUTPUT"
+   exit 1
+}
+
+# ................................................................
+
+cat <<EOT > "$ORDER"
+/* Comment */
+*(.text.NotHot .text.NotHot.*)
+__hot_text_start = .;
+/* UpdateWorld: 1.00 calls/frame */
+*(.text.UpdateWorld .text.UpdateWorld.*)
+*(.text.Min .text.Min.*)
+*(.text.DrawSpringsAndPlatforms .text.DrawSpringsAndPlatforms.*)
+*(.text.Inlined .text.Inlined.*)
+*(.text.Elsewhere .text.Elsewhere.*)
+__hot_text_end = .;
+*(.text.Cold .text.Cold.*)
+EOT
+
+# Sections listed before the memory map and in the cross reference table
+# should be ignored.
+cat <<EOT > "$MAP"
+Discarded input sections
+
+ .text.UpdateWorld
+                0x00000000      0x999 unused.o
+
+Memory Configuration
+
+Linker script and memory map
+
+.text           0x00000000     0x2000
+ *(.text.UpdateWorld .text.UpdateWorld.*)
+                0x00000100                __hot_text_start = .
+ .text.UpdateWorld
+                0x00000100      0x100 /tmp/cc.ltrans0.ltrans.o
+                0x00000100                UpdateWorld
+ .text.Min      0x00000200       0x10 /tmp/cc.ltrans0.ltrans.o
+ .text.Min.constprop.0
+                0x00000210        0x8 /tmp/cc.ltrans0.ltrans.o
+ .text.DrawSpringsAndPlatforms
+                0x00000220       0x30 /tmp/cc.ltrans1.ltrans.o
+                0x00000250                __hot_text_end = .
+ .text.Cold     0x00000250       0x40 /tmp/cc.ltrans1.ltrans.o
+ .text.Elsewhere
+                0x00001000       0x20 /tmp/cc.ltrans1.ltrans.o
+
+Cross Reference Table
+
+ .text.Inlined  0x00000300       0x10 unused.o
+EOT
+
+cat <<EOT > "$EXPECTED_OUTPUT"
+Hot functions:
+   0x00000100    256  UpdateWorld
+   0x00000200     24  Min
+   0x00000220     48  DrawSpringsAndPlatforms
+   0x00001000     32  Elsewhere  (outside hot range)
+Not found (inlined or removed): Inlined
+Hot set: 4 functions, 360 bytes, 12 cache lines (384 bytes)
+Hot range: 0x00000100..0x00000250, 336 bytes
+Instruction cache: 4096 bytes, hot set uses 9%
+EOT
+
+perl "$TOOL" "$ORDER" "$MAP" > "$ACTUAL_OUTPUT"
+if ! ( diff "$EXPECTED_OUTPUT" "$ACTUAL_OUTPUT" ); then
+   die "Output mismatched"
+fi
+
+# Map without hot range markers.
+grep -v __hot_text "$MAP" > "$ACTUAL_OUTPUT"
+if ( perl "$TOOL" "$ORDER" "$ACTUAL_OUTPUT" > /dev/null 2>&1 ); then
+   die "Missing hot range markers not detected"
+fi
+
+# ................................................................
+# Cleanup.
+rm -f "$ORDER" "$MAP" "$EXPECTED_OUTPUT" "$ACTUAL_OUTPUT"
+exit 0
@@ -0,0 +1,227 @@
+#include"hud.h"
+#include"common.h"
+#include"images.h"
+#include"profile.h"
+#include"work_count.h"
+
+// Offset of text shadow in pixels.
+#define SHADOW_OFFSET   2
+
+// Box dimensions for kHudBoxed style.
+#define BOX_PADDING_X   10
+#define BOX_PADDING_Y   5
+#define BOX_HEIGHT      25
+
+// Characters that have prerendered glyphs.  Minus sign comes first so that
+// digit glyphs are at (digit + 1).
+static const char kGlyphText[] = "-0123456789";
+#define GLYPH_COUNT     ((int)sizeof(kGlyphText) - 1)
+
+// Font used for labels.
+static LCDFont *g_font = NULL;
+
+// Prerendered glyphs, with black pixels where the text is and transparent
+// pixels elsewhere.
+static LCDBitmap *g_glyph[GLYPH_COUNT];
+
+// Horizontal advance for each glyph, including text tracking.
+static int g_glyph_width[GLYPH_COUNT];
+
+// Maximum value of g_glyph_width.
+static int g_max_glyph_width = 0;
+
+// Height of all glyphs.
+static int g_glyph_height = 0;
+
+// Render digit glyphs from font.
+void LoadHud(PlaydateAPI *pd, LCDFont *font)
+{
+   assert(font != NULL);
+   g_font = font;
+   g_glyph_height = pd->graphics->getFontHeight(font);
+
+   const int tracking = pd->graphics->getTextTracking();
+   for(int i = 0; i < GLYPH_COUNT; i++)
+   {
+      g_glyph_width[i] = pd->graphics->getTextWidth(
+         font, kGlyphText + i, 1, kASCIIEncoding, tracking);
+      if( g_max_glyph_width < g_glyph_width[i] )
+         g_max_glyph_width = g_glyph_width[i];
+
+      g_glyph[i] = pd->graphics->newBitmap(
+         g_glyph_width[i], g_glyph_height, kColorClear);
+      assert(g_glyph[i] != NULL);
+      pd->graphics->pushContext(g_glyph[i]);
+      pd->graphics->setFont(font);
+      pd->graphics->setDrawMode(kDrawModeCopy);
+      pd->graphics->drawText(kGlyphText + i, 1, kASCIIEncoding, 0, 0);
+      pd->graphics->popContext();
+   }
+
+   #ifndef NDEBUG
+      int bytes = 0;
+      for(int i = 0; i < GLYPH_COUNT; i++)
+         bytes += GetBitmapBytes(g_glyph[i], pd);
+      RecordImageMemory("hud glyphs", bytes);
+   #endif
+}
+
+// Preallocate bitmap for a HUD number.
+void InitHudNumber(HudNumber *number, const char *label, PlaydateAPI *pd)
+{
+   assert(g_font != NULL);
+   number->label = label;
+   number->valid = 0;
+
+   int width, height;
+   if( label != NULL )
+   {
+      number->label_width = pd->graphics->getTextWidth(
+         g_font,
+         label,
+         strlen(label),
+         kASCIIEncoding,
+         pd->graphics->getTextTracking());
+      width = number->label_width +
+              HUD_NUMBER_MAX_LENGTH * g_max_glyph_width +
+              2 * BOX_PADDING_X;
+      height = BOX_HEIGHT;
+   }
+   else
+   {
+      number->label_width = 0;
+      width = HUD_NUMBER_MAX_LENGTH * g_max_glyph_width + SHADOW_OFFSET;
+      height = g_glyph_height + SHADOW_OFFSET;
+   }
+   number->bitmap = pd->graphics->newBitmap(width, height, kColorClear);
+   assert(number->bitmap != NULL);
+   #ifndef NDEBUG
+      RecordImageMemory(label != NULL ? label : "hud number",
+                        GetBitmapBytes(number->bitmap, pd));
+   #endif
+}
+
+// Format integer to string.
+int FormatHudNumber(int value, char *text)
+{
+   // Write digits backwards into a temporary buffer.  Magnitude is
+   // computed as unsigned so that INT_MIN doesn't overflow.
+   char digits[HUD_NUMBER_MAX_LENGTH];
+   unsigned int magnitude = value < 0 ? 0U - (unsigned int)value
+                                      : (unsigned int)value;
+   int digit_count = 0;
+   do
+   {
+      digits[digit_count++] = '0' + magnitude % 10;
+      magnitude /= 10;
+   } while( magnitude > 0 );
+
+   int length = 0;
+   if( value < 0 )
+      text[length++] = '-';
+   while( digit_count > 0 )
+      text[length++] = digits[--digit_count];
+   text[length] = '\0';
+   assert(length <= HUD_NUMBER_MAX_LENGTH);
+   return length;
+}
+
+// Get glyph index for a character produced by FormatHudNumber.
+static int GetGlyphIndex(char c)
+{
+   if( c == '-' )
+      return 0;
+   assert(c >= '0' && c <= '9');
+   return c - '0' + 1;
+}
+
+// Get width of formatted text in pixels.
+static int GetGlyphsWidth(const char *text, int length)
+{
+   int width = 0;
+   for(int i = 0; i < length; i++)
+      width += g_glyph_width[GetGlyphIndex(text[i])];
+   return width;
+}
+
+// Draw formatted text using prerendered glyphs, using the current draw mode.
+static void DrawGlyphs(const char *text, int length, int x, int y,
+                       PlaydateAPI *pd)
+{
+   COUNT_WORK(kWorkBlit, length);
+   for(int i = 0; i < length; i++)
+   {
+      const int g = GetGlyphIndex(text[i]);
+      pd->graphics->drawBitmap(g_glyph[g], x, y, kBitmapUnflipped);
+      x += g_glyph_width[g];
+   }
+}
+
+// Update cached bitmap to match current value and style.
+static void RenderHudNumber(HudNumber *number, PlaydateAPI *pd)
+{
+   char text[HUD_NUMBER_MAX_LENGTH + 1];
+   const int length = FormatHudNumber(number->value, text);
+
+   pd->graphics->clearBitmap(number->bitmap, kColorClear);
+   pd->graphics->pushContext(number->bitmap);
+   switch( number->style )
+   {
+      case kHudWhiteOnBlack:
+         pd->graphics->setDrawMode(kDrawModeFillBlack);
+         DrawGlyphs(text, length, SHADOW_OFFSET, SHADOW_OFFSET, pd);
+         pd->graphics->setDrawMode(kDrawModeFillWhite);
+         DrawGlyphs(text, length, 0, 0, pd);
+         break;
+
+      case kHudBlackOnWhite:
+         pd->graphics->setDrawMode(kDrawModeFillWhite);
+         DrawGlyphs(text, length, SHADOW_OFFSET, SHADOW_OFFSET, pd);
+         pd->graphics->setDrawMode(kDrawModeFillBlack);
+         DrawGlyphs(text, length, 0, 0, pd);
+         break;
+
+      case kHudBoxed:
+         assert(number->label != NULL);
+         pd->graphics->setDrawMode(kDrawModeCopy);
+         pd->graphics->fillRect(
+            0,
+            0,
+            number->label_width + GetGlyphsWidth(text, length) +
+               2 * BOX_PADDING_X,
+            BOX_HEIGHT,
+            kColorWhite);
+         pd->graphics->setFont(g_font);
+         pd->graphics->drawText(number->label,
+                                strlen(number->label),
+                                kASCIIEncoding,
+                                BOX_PADDING_X,
+                                BOX_PADDING_Y);
+         DrawGlyphs(text,
+                    length,
+                    BOX_PADDING_X + number->label_width,
+                    BOX_PADDING_Y,
+                    pd);
+         break;
+   }
+   pd->graphics->setDrawMode(kDrawModeCopy);
+   pd->graphics->popContext();
+   number->valid = 1;
+}
+
+// Draw a number.
+void DrawHudNumber(HudNumber *number, int value, HudStyle style,
+                   int x, int y, PlaydateAPI *pd)
+{
+   PROFILE_SCOPE(kProfileDrawHud);
+
+   assert(number->bitmap != NULL);
+   if( !number->valid || number->value != value || number->style != style )
+   {
+      number->value = value;
+      number->style = style;
+      RenderHudNumber(number, pd);
+   }
+   COUNT_WORK(kWorkBlit, 1);
+   pd->graphics->drawBitmap(number->bitmap, x, y, kBitmapUnflipped);
+}
@@ -0,0 +1,73 @@
+// Library for drawing numbers that are updated every frame.
+//
+// Text drawn with formatString+drawText costs a heap allocation and a full
+// text layout pass on every frame.  Instead, we render the digit glyphs
+// once at load time, and compose them into a cached bitmap that is only
+// redrawn when the displayed value changes.
+
+#ifndef HUD_H_
+#define HUD_H_
+
+#include"pd_api.h"
+
+// Maximum number of characters needed to format a 32bit integer, including
+// the minus sign.
+#define HUD_NUMBER_MAX_LENGTH    11
+
+// Rendering styles for HUD numbers.
+typedef enum
+{
+   // White text with black shadow, for dark backgrounds.
+   kHudWhiteOnBlack,
+
+   // Black text with white shadow, for light backgrounds.
+   kHudBlackOnWhite,
+
+   // Black text on a white box, with a text label in front of the number.
+   kHudBoxed
+} HudStyle;
+
+// A number along with its cached rendering.
+typedef struct
+{
+   // Optional text to be drawn in front of the number, only used for
+   // kHudBoxed style.  This must be a string with static lifetime.
+   const char *label;
+
+   // Width of label text in pixels.
+   int label_width;
+
+   // Preallocated bitmap holding the last rendered text.
+   LCDBitmap *bitmap;
+
+   // Value and style used in the last rendering.  Bitmap is only updated
+   // when these change.
+   int value;
+   HudStyle style;
+
+   // Nonzero if bitmap contains the rendering of the current value.
+   int valid;
+} HudNumber;
+
+// Render digit glyphs from font.  Must be called before any of the other
+// HUD functions.
+void LoadHud(PlaydateAPI *pd, LCDFont *font);
+
+// Preallocate bitmap for a HUD number.  label may be NULL.
+void InitHudNumber(HudNumber *number, const char *label, PlaydateAPI *pd);
+
+// Write decimal representation of value to text, which must have room for
+// at least HUD_NUMBER_MAX_LENGTH+1 bytes.  Returns length of output,
+// excluding the terminating NUL.
+int FormatHudNumber(int value, char *text);
+
+// Draw a number with its top left corner at the specified position.
+//
+// For kHudWhiteOnBlack and kHudBlackOnWhite styles, the shadow is drawn at
+// 2 pixels below and to the right of the text.  For kHudBoxed style, the
+// box is drawn with 10 pixels of horizontal padding and 5 pixels of
+// vertical padding.
+void DrawHudNumber(HudNumber *number, int value, HudStyle style,
+                   int x, int y, PlaydateAPI *pd);
+
+#endif  // HUD_H_
@@ -0,0 +1,357 @@
+#include"images.h"
+#include<string.h>
+#include"common.h"
+#include"bgm.h"
+#include"heap.h"
+#include"log_ring.h"
+
+#if IMAGE_BUNDLE
+   #include"bundle_format.h"
+
+   // Bundle file name.  This is copied to the package as is, since pdc
+   // passes through files that it doesn't know how to compile.
+   #define BUNDLE_PATH  "images.bundle"
+
+   // Bundle file, opened by OpenImages.  This is kept open for the whole
+   // run, so that images freed by the caller can be loaded again with a
+   // seek and a few reads.
+   static SDFile *g_bundle_file = NULL;
+
+   // Bundle header and entry index, loaded by OpenImages.  Pixel data is
+   // read directly into bitmaps and doesn't stay in memory.
+   static BundleHeader g_bundle_header;
+   static BundleEntry *g_bundle_entries = NULL;
+#endif
+
+#ifndef NDEBUG
+// Load statistics since the last ReportImageLoads call.  Load time is
+// measured with the audio sample clock, since elapsed time may be in use
+// by the profiler.
+static int g_file_count = 0;
+static int g_bytes_read = 0;
+static uint32_t g_load_samples = 0;
+
+// Maximum number of distinct images for ReportImageMemory.
+#define MAX_IMAGE_RECORDS  32
+
+// Image sizes recorded by RecordImageMemory.
+typedef struct
+{
+   const char *name;
+   int bytes;
+   int loads;
+} ImageRecord;
+static ImageRecord g_image_record[MAX_IMAGE_RECORDS];
+static int g_image_record_count = 0;
+#endif
+
+#if IMAGE_BUNDLE
+
+// Find a bundle entry by name and type.
+static const BundleEntry *FindEntry(const char *name, int is_table)
+{
+   assert(g_bundle_entries != NULL);
+   const BundleEntry *entry = g_bundle_entries;
+   for(int i = 0; i < g_bundle_header.entry_count; i++)
+   {
+      if( entry[i].is_table == is_table &&
+          strncmp(entry[i].name, name, BUNDLE_NAME_SIZE) == 0 )
+         return entry + i;
+   }
+   return NULL;
+}
+
+// Read bytes from the current position of bundle file.
+static void ReadBundle(PlaydateAPI *pd, void *buffer, int size)
+{
+   if( pd->file->read(g_bundle_file, buffer, size) != size )
+   {
+      pd->system->error("Error reading %s: %s",
+                        BUNDLE_PATH, pd->file->geterr());
+   }
+   #ifndef NDEBUG
+      g_bytes_read += size;
+   #endif
+}
+
+// Move bundle file position to the first cell of an entry.
+static void SeekEntry(PlaydateAPI *pd, const BundleEntry *entry)
+{
+   if( pd->file->seek(g_bundle_file, entry->offset, SEEK_SET) != 0 )
+   {
+      pd->system->error("Error reading %s: %s",
+                        BUNDLE_PATH, pd->file->geterr());
+   }
+}
+
+// Read one plane of pixels or mask into bitmap data.
+static void ReadPlane(PlaydateAPI *pd,
+                      const BundleEntry *entry,
+                      uint8_t *data,
+                      int row_bytes)
+{
+   // Row sizes are normally the same, in which case the whole plane is
+   // read with a single call.
+   if( row_bytes == entry->row_bytes )
+   {
+      ReadBundle(pd, data, row_bytes * entry->height);
+      return;
+   }
+
+   // Read row by row in case the system pads bitmap rows differently from
+   // the bundle.
+   uint8_t row[BUNDLE_ROW_BYTES(LCD_COLUMNS)];
+   assert(entry->row_bytes <= (int)sizeof(row));
+   const int copy_bytes =
+      row_bytes < entry->row_bytes ? row_bytes : entry->row_bytes;
+   for(int y = 0; y < entry->height; y++)
+   {
+      ReadBundle(pd, row, entry->row_bytes);
+      memcpy(data + y * row_bytes, row, copy_bytes);
+   }
+}
+
+// Read pixels and mask of the next cell from bundle file to a bitmap.
+static void ReadCell(PlaydateAPI *pd,
+                     const BundleEntry *entry,
+                     LCDBitmap *bitmap)
+{
+   int width, height, row_bytes;
+   uint8_t *mask, *data;
+   pd->graphics->getBitmapData(bitmap,
+                               &width, &height, &row_bytes, &mask, &data);
+   if( mask == NULL )
+   {
+      // Bitmaps from newBitmapTable don't have a mask, so add one here.
+      // setBitmapMask copies the mask pixels, so the temporary bitmap can
+      // be freed right away.
+      LCDBitmap *m = pd->graphics->newBitmap(width, height, kColorWhite);
+      assert(m != NULL);
+      #ifndef NDEBUG
+         CountApiAllocation(GetBitmapBytes(m, pd));
+      #endif
+      pd->graphics->setBitmapMask(bitmap, m);
+      pd->graphics->freeBitmap(m);
+      pd->graphics->getBitmapData(bitmap,
+                                  &width, &height, &row_bytes, &mask, &data);
+      assert(mask != NULL);
+   }
+   assert(width == entry->width);
+   assert(height == entry->height);
+   assert(row_bytes >= (width + 7) / 8);
+
+   ReadPlane(pd, entry, data, row_bytes);
+   ReadPlane(pd, entry, mask, row_bytes);
+}
+
+#else
+
+#ifndef NDEBUG
+// Count size of a compiled image file.
+static void CountFile(PlaydateAPI *pd, const char *path, const char *suffix)
+{
+   // Images may be loaded while the game is in progress, so the path is
+   // built in frame arena instead of going through formatString.
+   const int path_length = strlen(path);
+   const int suffix_length = strlen(suffix);
+   char *full_path = AllocateFrame(path_length + suffix_length + 1);
+   if( full_path == NULL )
+      return;
+   memcpy(full_path, path, path_length);
+   memcpy(full_path + path_length, suffix, suffix_length + 1);
+
+   FileStat stat;
+   if( pd->file->stat(full_path, &stat) == 0 )
+      g_bytes_read += stat.size;
+   g_file_count++;
+}
+#endif
+
+#endif  // IMAGE_BUNDLE
+
+// Read image bundle.
+void OpenImages(PlaydateAPI *pd)
+{
+   #if IMAGE_BUNDLE
+      #ifndef NDEBUG
+         const uint32_t start = pd->sound->getCurrentTime();
+      #endif
+
+      g_bundle_file = pd->file->open(BUNDLE_PATH, kFileRead);
+      if( g_bundle_file == NULL )
+      {
+         pd->system->error("Error reading %s: %s",
+                           BUNDLE_PATH, pd->file->geterr());
+         return;
+      }
+
+      // Only the header and entry index are loaded here.  Pixel data is
+      // read by LoadImage and LoadImageTable.
+      ReadBundle(pd, &g_bundle_header, sizeof(BundleHeader));
+      assert(memcmp(g_bundle_header.magic, BUNDLE_MAGIC, 4) == 0);
+      assert(g_bundle_header.version == BUNDLE_VERSION);
+      const int index_size =
+         g_bundle_header.entry_count * (int)sizeof(BundleEntry);
+      g_bundle_entries = pd->system->realloc(NULL, index_size);
+      assert(g_bundle_entries != NULL);
+      ReadBundle(pd, g_bundle_entries, index_size);
+
+      #ifndef NDEBUG
+         g_file_count++;
+         g_load_samples += pd->sound->getCurrentTime() - start;
+      #endif
+   #else
+      (void)pd;
+   #endif
+}
+
+// Load an image table.
+LCDBitmapTable *LoadImageTable(PlaydateAPI *pd, const char *path)
+{
+   #ifndef NDEBUG
+      const uint32_t start = pd->sound->getCurrentTime();
+   #endif
+
+   #if IMAGE_BUNDLE
+      const BundleEntry *entry = FindEntry(path, 1);
+      assert(entry != NULL);
+      LCDBitmapTable *table = pd->graphics->newBitmapTable(
+         entry->count, entry->width, entry->height);
+      assert(table != NULL);
+      SeekEntry(pd, entry);
+      for(int i = 0; i < entry->count; i++)
+         ReadCell(pd, entry, pd->graphics->getTableBitmap(table, i));
+   #else
+      const char *error;
+      LCDBitmapTable *table = pd->graphics->loadBitmapTable(path, &error);
+      assert(table != NULL);
+      #ifndef NDEBUG
+         CountFile(pd, path, ".pdt");
+      #endif
+   #endif
+
+   #ifndef NDEBUG
+      g_load_samples += pd->sound->getCurrentTime() - start;
+      const int bytes = GetTableBytes(table, pd);
+      RecordImageMemory(path, bytes);
+      CountApiAllocation(bytes);
+   #endif
+   return table;
+}
+
+// Load a single image.
+LCDBitmap *LoadImage(PlaydateAPI *pd, const char *path)
+{
+   #ifndef NDEBUG
+      const uint32_t start = pd->sound->getCurrentTime();
+   #endif
+
+   #if IMAGE_BUNDLE
+      const BundleEntry *entry = FindEntry(path, 0);
+      assert(entry != NULL);
+      assert(entry->count == 1);
+      LCDBitmap *bitmap =
+         pd->graphics->newBitmap(entry->width, entry->height, kColorClear);
+      assert(bitmap != NULL);
+      SeekEntry(pd, entry);
+      ReadCell(pd, entry, bitmap);
+   #else
+      const char *error;
+      LCDBitmap *bitmap = pd->graphics->loadBitmap(path, &error);
+      assert(bitmap != NULL);
+      #ifndef NDEBUG
+         CountFile(pd, path, ".pdi");
+      #endif
+   #endif
+
+   #ifndef NDEBUG
+      g_load_samples += pd->sound->getCurrentTime() - start;
+      const int bytes = GetBitmapBytes(bitmap, pd);
+      RecordImageMemory(path, bytes);
+      CountApiAllocation(bytes);
+   #endif
+   return bitmap;
+}
+
+// Log load statistics.
+void ReportImageLoads(void)
+{
+   #ifndef NDEBUG
+      LOG_EVENT("images: %d files, %d bytes read, %d us",
+                g_file_count,
+                g_bytes_read,
+                (int)((int64_t)g_load_samples * 1000000 / SAMPLE_RATE));
+      g_file_count = 0;
+      g_bytes_read = 0;
+      g_load_samples = 0;
+   #endif
+}
+
+// Get number of bytes used by pixels and mask of a bitmap.
+int GetBitmapBytes(LCDBitmap *bitmap, PlaydateAPI *pd)
+{
+   int width, height, row_bytes;
+   uint8_t *mask, *data;
+   pd->graphics->getBitmapData(bitmap,
+                               &width, &height, &row_bytes, &mask, &data);
+   return row_bytes * height * (mask != NULL ? 2 : 1);
+}
+
+// Get number of bytes used by a bitmap table.
+int GetTableBytes(LCDBitmapTable *table, PlaydateAPI *pd)
+{
+   int count, cells_wide;
+   pd->graphics->getBitmapTableInfo(table, &count, &cells_wide);
+   return count * GetBitmapBytes(pd->graphics->getTableBitmap(table, 0), pd);
+}
+
+// Record image size.
+void RecordImageMemory(const char *name, int bytes)
+{
+   #ifndef NDEBUG
+      int i = 0;
+      for(; i < g_image_record_count; i++)
+      {
+         if( strcmp(g_image_record[i].name, name) == 0 )
+            break;
+      }
+      if( i == g_image_record_count )
+      {
+         if( g_image_record_count == MAX_IMAGE_RECORDS )
+            return;
+         g_image_record_count++;
+         g_image_record[i].name = name;
+         g_image_record[i].loads = 0;
+      }
+      g_image_record[i].bytes = bytes;
+      g_image_record[i].loads++;
+   #else
+      (void)name;
+      (void)bytes;
+   #endif
+}
+
+// Log image sizes.
+void ReportImageMemory(void (*log)(const char *format, ...))
+{
+   #ifndef NDEBUG
+      int total_bytes = 0;
+      for(int i = 0; i < g_image_record_count; i++)
+      {
+         log("memory: image %s = %d bytes, %d loads",
+             g_image_record[i].name,
+             g_image_record[i].bytes,
+             g_image_record[i].loads);
+         total_bytes += g_image_record[i].bytes;
+      }
+      log("memory: %d images = %d bytes if all are resident",
+          g_image_record_count, total_bytes);
+      #if IMAGE_BUNDLE
+         log("memory: bundle index = %d bytes resident",
+             (int)(sizeof(BundleHeader) +
+                   g_bundle_header.entry_count * sizeof(BundleEntry)));
+      #endif
+   #else
+      (void)log;
+   #endif
+}
@@ -0,0 +1,51 @@
+// Library for loading images.
+//
+// By default, images are loaded from individual files with loadBitmap and
+// loadBitmapTable, which costs a file open and a decode for each image.
+// Building with IMAGE_BUNDLE=1 loads images from a single bundle file
+// instead (see bundle_format.h).  OpenImages opens the bundle and reads
+// its index, and bitmaps are then built by reading raw pixels directly
+// into bitmap data, without decoding or opening more files.
+//
+// Only the index stays in memory after OpenImages.  The bundle file is
+// kept open, so that images freed by the caller can be loaded again with
+// a seek and a few reads.
+
+#ifndef IMAGES_H_
+#define IMAGES_H_
+
+#include"pd_api.h"
+
+// Read image bundle, if enabled.  Must be called before any of the other
+// image functions.
+void OpenImages(PlaydateAPI *pd);
+
+// Load an image table, using the same path as loadBitmapTable.
+LCDBitmapTable *LoadImageTable(PlaydateAPI *pd, const char *path);
+
+// Load a single image, using the same path as loadBitmap.
+LCDBitmap *LoadImage(PlaydateAPI *pd, const char *path);
+
+// Log number of files opened, number of bytes read, and time spent loading
+// images since the last report, and reset counters.  This is a no-op in
+// release builds.
+void ReportImageLoads(void);
+
+// Get number of bytes used by pixels and mask of a bitmap.
+int GetBitmapBytes(LCDBitmap *bitmap, PlaydateAPI *pd);
+
+// Get number of bytes used by a bitmap table.
+int GetTableBytes(LCDBitmapTable *table, PlaydateAPI *pd);
+
+// Record heap size of an image for ReportImageMemory.  This is called by
+// LoadImage and LoadImageTable, and can also be called for bitmaps that
+// are created by other means.  Name must have static lifetime.  This is a
+// no-op in release builds.
+void RecordImageMemory(const char *name, int bytes);
+
+// Log size and number of loads of each image recorded since startup.  Image
+// names are not integers, so this uses the log function directly instead
+// of LOG_EVENT.  This is a no-op in release builds.
+void ReportImageMemory(void (*log)(const char *format, ...));
+
+#endif  // IMAGES_H_
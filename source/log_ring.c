@@ -0,0 +1,106 @@
+#include"log_ring.h"
+
+// A single log entry.
+typedef struct
+{
+   // Format string, or plain text if is_text is set.
+   const char *format;
+   int is_text;
+   int arg[LOG_ARG_COUNT];
+} LogEntry;
+
+// Ring buffer of pending entries.
+static LogEntry g_ring[LOG_RING_SIZE];
+
+// Index of oldest pending entry.
+static int g_ring_start = 0;
+
+// Number of pending entries.
+static int g_ring_size = 0;
+
+// Number of entries that were overwritten before they were flushed.
+static int g_dropped = 0;
+
+// Get slot for a new entry, overwriting the oldest entry if ring is full.
+static LogEntry *NewLogEntry(void)
+{
+   if( g_ring_size == LOG_RING_SIZE )
+   {
+      g_ring_start = (g_ring_start + 1) % LOG_RING_SIZE;
+      g_ring_size--;
+      g_dropped++;
+   }
+   LogEntry *entry = &g_ring[(g_ring_start + g_ring_size) % LOG_RING_SIZE];
+   g_ring_size++;
+   return entry;
+}
+
+// Add a log entry.
+void AddLogEntry(const char *format, int a0, int a1, int a2, int a3,
+                 int a4, int a5, int a6, int a7)
+{
+   LogEntry *entry = NewLogEntry();
+   entry->format = format;
+   entry->is_text = 0;
+   entry->arg[0] = a0;
+   entry->arg[1] = a1;
+   entry->arg[2] = a2;
+   entry->arg[3] = a3;
+   entry->arg[4] = a4;
+   entry->arg[5] = a5;
+   entry->arg[6] = a6;
+   entry->arg[7] = a7;
+}
+
+// Add a plain text entry.
+void AddLogText(const char *text)
+{
+   LogEntry *entry = NewLogEntry();
+   entry->format = text;
+   entry->is_text = 1;
+}
+
+// Output pending entries.
+int FlushLogRing(void (*log)(const char *format, ...), int max_entries)
+{
+   if( g_dropped > 0 )
+   {
+      log("log: %d entries dropped", g_dropped);
+      g_dropped = 0;
+   }
+
+   int count = 0;
+   for(; count < max_entries && g_ring_size > 0; count++)
+   {
+      const LogEntry *entry = &g_ring[g_ring_start];
+      if( entry->is_text )
+      {
+         log("%s", entry->format);
+      }
+      else
+      {
+         // Always pass all arguments, the extra ones are ignored by
+         // the log function.
+         log(entry->format,
+             entry->arg[0], entry->arg[1], entry->arg[2], entry->arg[3],
+             entry->arg[4], entry->arg[5], entry->arg[6], entry->arg[7]);
+      }
+      g_ring_start = (g_ring_start + 1) % LOG_RING_SIZE;
+      g_ring_size--;
+   }
+   return count;
+}
+
+// Get number of pending entries.
+int GetLogRingSize(void)
+{
+   return g_ring_size;
+}
+
+// Discard pending entries.
+void ClearLogRing(void)
+{
+   g_ring_start = 0;
+   g_ring_size = 0;
+   g_dropped = 0;
+}
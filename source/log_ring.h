@@ -0,0 +1,60 @@
+// Library for deferred debug logging.
+//
+// logToConsole formats its output immediately and sends it to the serial
+// console, which takes long enough to show up in frame timings.  Instead,
+// LOG_EVENT saves a pointer to the format string along with the raw integer
+// arguments in a fixed-size ring buffer, and formatting is done later by
+// FlushLogRing when there is time to spare.
+//
+// Format strings must have static lifetime, and all arguments must be
+// integers.  If more than LOG_RING_SIZE entries are added between flushes,
+// the oldest entries are overwritten.
+//
+// LOG_EVENT is a no-op in release builds.  This library doesn't depend on
+// Playdate API, so that it can be tested on the host.
+
+#ifndef LOG_RING_H_
+#define LOG_RING_H_
+
+// Maximum number of pending entries.
+#define LOG_RING_SIZE   256
+
+// Maximum number of arguments per entry.
+#define LOG_ARG_COUNT   8
+
+// Add a log entry.  Usage is same as printf, except with at most
+// LOG_ARG_COUNT integer arguments.
+#ifndef NDEBUG
+   #define LOG_EVENT(...)  \
+      LOG_EVENT_IMPL(__VA_ARGS__, 0, 0, 0, 0, 0, 0, 0, 0, 0)
+   #define LOG_EVENT_IMPL(format, a0, a1, a2, a3, a4, a5, a6, a7, ...) \
+      AddLogEntry(format, (int)(a0), (int)(a1), (int)(a2), (int)(a3),    \
+                  (int)(a4), (int)(a5), (int)(a6), (int)(a7))
+#else
+   #define LOG_EVENT(...)  ((void)0)
+#endif
+
+// Convert a macro value such as __LINE__ to string literal.
+#define LOG_STRINGIFY(x)         LOG_STRINGIFY_IMPL(x)
+#define LOG_STRINGIFY_IMPL(x)    #x
+
+// Add a log entry with a format string and exactly LOG_ARG_COUNT arguments.
+void AddLogEntry(const char *format, int a0, int a1, int a2, int a3,
+                 int a4, int a5, int a6, int a7);
+
+// Add a log entry that is a plain string without format specifiers.  This
+// is for text that might contain a stray "%", such as stringified
+// expressions.
+void AddLogText(const char *text);
+
+// Format and output up to max_entries pending entries using the specified
+// log function, oldest first.  Returns number of entries written.
+int FlushLogRing(void (*log)(const char *format, ...), int max_entries);
+
+// Get number of pending entries.
+int GetLogRingSize(void);
+
+// Discard all pending entries.
+void ClearLogRing(void);
+
+#endif  // LOG_RING_H_
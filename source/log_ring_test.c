@@ -0,0 +1,105 @@
+#include<assert.h>
+#include<stdarg.h>
+#include<stdio.h>
+#include<string.h>
+#include"log_ring.h"
+
+// Captured output from CaptureLog.
+static char g_output[0x4000];
+
+// Log function that appends formatted output to g_output, one line per call.
+static void CaptureLog(const char *format, ...)
+{
+   const size_t length = strlen(g_output);
+   va_list args;
+   va_start(args, format);
+   vsnprintf(g_output + length, sizeof(g_output) - length, format, args);
+   va_end(args);
+   strncat(g_output, "\n", sizeof(g_output) - strlen(g_output) - 1);
+}
+
+// Flush all pending entries to g_output.
+static int FlushAll(void)
+{
+   g_output[0] = '\0';
+   return FlushLogRing(CaptureLog, LOG_RING_SIZE);
+}
+
+static void TestEmpty(void)
+{
+   ClearLogRing();
+   assert(GetLogRingSize() == 0);
+   assert(FlushAll() == 0);
+   assert(strcmp(g_output, "") == 0);
+}
+
+static void TestArguments(void)
+{
+   ClearLogRing();
+   LOG_EVENT("no arguments");
+   LOG_EVENT("one argument: %d", 1);
+   LOG_EVENT("%d %d %d %d %d %d %d %d", 1, 2, 3, 4, 5, 6, 7, 8);
+   LOG_EVENT("hex: %x", 255);
+   AddLogText("text: 100% literal");
+   assert(GetLogRingSize() == 5);
+
+   assert(FlushAll() == 5);
+   assert(GetLogRingSize() == 0);
+   assert(strcmp(g_output,
+                 "no arguments\n"
+                 "one argument: 1\n"
+                 "1 2 3 4 5 6 7 8\n"
+                 "hex: ff\n"
+                 "text: 100% literal\n") == 0);
+}
+
+static void TestPartialFlush(void)
+{
+   ClearLogRing();
+   for(int i = 0; i < 5; i++)
+      LOG_EVENT("%d", i);
+
+   g_output[0] = '\0';
+   assert(FlushLogRing(CaptureLog, 2) == 2);
+   assert(strcmp(g_output, "0\n1\n") == 0);
+   assert(GetLogRingSize() == 3);
+
+   // New entries are appended after the remaining ones.
+   LOG_EVENT("%d", 5);
+   assert(FlushAll() == 4);
+   assert(strcmp(g_output, "2\n3\n4\n5\n") == 0);
+}
+
+static void TestOverflow(void)
+{
+   ClearLogRing();
+   for(int i = 0; i < LOG_RING_SIZE + 3; i++)
+      LOG_EVENT("%d", i);
+   assert(GetLogRingSize() == LOG_RING_SIZE);
+
+   assert(FlushAll() == LOG_RING_SIZE);
+   const char *expected_prefix = "log: 3 entries dropped\n3\n4\n";
+   assert(strncmp(g_output, expected_prefix, strlen(expected_prefix)) == 0);
+
+   char expected_suffix[32];
+   sprintf(expected_suffix, "\n%d\n", LOG_RING_SIZE + 2);
+   assert(strcmp(g_output + strlen(g_output) - strlen(expected_suffix),
+                 expected_suffix) == 0);
+
+   // Dropped count is only reported once.
+   LOG_EVENT("after");
+   assert(FlushAll() == 1);
+   assert(strcmp(g_output, "after\n") == 0);
+}
+
+int main(int argc, char **argv)
+{
+   (void)argc;
+   (void)argv;
+
+   TestEmpty();
+   TestArguments();
+   TestPartialFlush();
+   TestOverflow();
+   return 0;
+}
@@ -5,7 +5,16 @@
 
 #include"common.h"
 #include"bgm.h"
+#include"heap.h"
+#include"hud.h"
+#include"images.h"
+#include"log_ring.h"
+#include"playback.h"
+#include"profile.h"
+#include"refresh.h"
+#include"sfx.h"
 #include"slime.h"
+#include"trace.h"
 #include"world.h"
 
 // Syntactic sugar.
@@ -16,12 +25,9 @@
 #define ANY_BUTTON   (kButtonA | kButtonB | \
                       kButtonUp | kButtonDown | kButtonLeft | kButtonRight)
 
-// Saved pointer to PlaydateAPI, used for our assert hack.  See common.h.
-#if TARGET_PLAYDATE
-#ifndef NDEBUG
-PlaydateAPI *g_pd;
-#endif
-#endif
+// Maximum number of log entries to write per frame while game is in
+// progress.  See FlushLog.
+#define LOG_FLUSH_BATCH_SIZE  4
 
 // Version info.
 #include"build/version.txt"
@@ -57,6 +63,51 @@ static LCDFont *g_bold_font = NULL;
 // Image handles.
 static LCDBitmap *g_title = NULL;
 static LCDBitmap *g_info = NULL;
+static LCDBitmap *g_start_prompt = NULL;
+
+// Cached rendering of game over stats.
+static HudNumber g_final_height;
+static HudNumber g_peak_height;
+static HudNumber g_longest_fall;
+
+// If nonzero, title and game over screens will be redrawn on the next
+// frame.  Those screens only change in response to world updates and button
+// presses, apart from state transitions and menu changes.  When none of
+// those happened, we skip drawing and leave the previous frame on screen.
+static int g_force_redraw = 1;
+
+// Nonzero if all world images have been loaded.  Only the images needed
+// for the title screen are loaded during kEventInit, the remaining images
+// are loaded one per frame afterwards.
+static int g_images_loaded = 0;
+
+// Platform style for the song phase that is coming up next, for loading
+// platform images ahead of phase changes.
+static PlatformStyle g_upcoming_style = kPlatformTrees;
+
+#ifndef NDEBUG
+// Frame counters for title and game over screens, for measuring the number
+// of frames where drawing was skipped.
+static int g_idle_frames = 0;
+static int g_static_screen_frames = 0;
+
+// Time when kEventInit started, for measuring startup time.
+static unsigned int g_init_start_time = 0;
+static int g_first_frame_drawn = 0;
+#endif
+
+#if ENABLE_REPLAY
+// Replay file to play back, see playback.h.
+#define REPLAY_PATH  "replay.txt"
+
+// Number of frames to look ahead for loading platform images, same as the
+// two seconds used by GetUpcomingSongPhase.
+#define REPLAY_PHASE_LOOK_AHEAD  (SIMULATION_RATE * 2)
+
+// Index of the next replay frame, or -1 if the current game is driven by
+// buttons and crank.
+static int g_replay_frame = -1;
+#endif
 
 // Menu options.
 static PDMenuItem *g_control_mode = NULL;
@@ -75,14 +126,6 @@ static void LoadFont(PlaydateAPI *pd)
       pd->graphics->setFont(g_bold_font);
 }
 
-// Load title image.
-static void LoadTitle(PlaydateAPI *pd)
-{
-   const char *error;
-   g_title = pd->graphics->loadBitmap("title", &error);
-   assert(g_title != NULL);
-}
-
 // Draw black text on white rectangle.
 static void DrawBoxedText(PlaydateAPI *pd, const char *text, int x, int y)
 {
@@ -98,6 +141,40 @@ static void DrawBoxedText(PlaydateAPI *pd, const char *text, int x, int y)
    pd->graphics->drawText(text, length, kASCIIEncoding, x + 10, y + 5);
 }
 
+// Load title image.
+static void LoadTitle(PlaydateAPI *pd)
+{
+   g_title = LoadImage(pd, "title");
+
+   // Prerender the start prompt, so that we don't need to measure the text
+   // on every frame.
+   static const char kStartPrompt[] = "press A to start";
+   const int prompt_width = pd->graphics->getTextWidth(
+      g_bold_font,
+      kStartPrompt,
+      strlen(kStartPrompt),
+      kASCIIEncoding,
+      pd->graphics->getTextTracking());
+   g_start_prompt =
+      pd->graphics->newBitmap(prompt_width + 20, 25, kColorClear);
+   assert(g_start_prompt != NULL);
+   pd->graphics->pushContext(g_start_prompt);
+   DrawBoxedText(pd, kStartPrompt, 0, 0);
+   pd->graphics->popContext();
+   #ifndef NDEBUG
+      RecordImageMemory("start prompt", GetBitmapBytes(g_start_prompt, pd));
+   #endif
+}
+
+// Initialize text that is updated every frame.
+static void LoadText(PlaydateAPI *pd)
+{
+   LoadHud(pd, g_bold_font);
+   InitHudNumber(&g_final_height, "Final height ", pd);
+   InitHudNumber(&g_peak_height, "Peak height ", pd);
+   InitHudNumber(&g_longest_fall, "Longest free fall ", pd);
+}
+
 // Initialize pause menu image.
 static void SetMenuImage(PlaydateAPI *pd)
 {
@@ -130,15 +207,160 @@ static void SetMenuImage(PlaydateAPI *pd)
 
    pd->graphics->popContext();
    pd->system->setMenuImage(g_info, 0);
+   #ifndef NDEBUG
+      RecordImageMemory("menu image", GetBitmapBytes(g_info, pd));
+   #endif
+}
+
+// Write pending log entries to console.  This is a no-op in release builds.
+static void FlushLog(PlaydateAPI *pd, int max_entries)
+{
+   #ifndef NDEBUG
+      FlushLogRing(pd->system->logToConsole, max_entries);
+   #endif
 }
 
+// Log the cost of adding a log entry, compared to calling logToConsole
+// directly.  This is called once during setup in debug builds.
+static void MeasureLogOverhead(PlaydateAPI *pd)
+{
+   #ifndef NDEBUG
+      pd->system->resetElapsedTime();
+      for(int i = 0; i < LOG_RING_SIZE; i++)
+         LOG_EVENT("log overhead test %d", i);
+      const float ring_time = pd->system->getElapsedTime();
+      ClearLogRing();
+
+      pd->system->resetElapsedTime();
+      pd->system->logToConsole("log: measuring overhead");
+      const float console_time = pd->system->getElapsedTime();
+
+      pd->system->logToConsole(
+         "log: LOG_EVENT = %d ns per call, logToConsole = %d ns per call",
+         (int)(ring_time * 1e9f / LOG_RING_SIZE),
+         (int)(console_time * 1e9f));
+   #endif
+}
+
+// Log fraction of idle frames for title or game over screen, and reset
+// frame counters.  This is called when leaving those screens.
+static void ReportIdleFrames(PlaydateAPI *pd)
+{
+   #ifndef NDEBUG
+      if( g_static_screen_frames > 0 )
+      {
+         LOG_EVENT(
+            g_game_state == kTitleScreen
+               ? "title: %d of %d frames idle (%d%%)"
+               : "game over: %d of %d frames idle (%d%%)",
+            g_idle_frames,
+            g_static_screen_frames,
+            g_idle_frames * 100 / g_static_screen_frames);
+      }
+      g_idle_frames = 0;
+      g_static_screen_frames = 0;
+   #endif
+}
+
+#ifndef NDEBUG
+// Beat timing stats, in samples.  See BeatEvent.
+static int g_beat_count = 0;
+static int g_beat_min_lateness = 0;
+static int g_beat_max_lateness = 0;
+static int g_beat_total_error = 0;
+
+// Convert sample count to microseconds.
+static int SamplesToMicroseconds(int samples)
+{
+   return (int)((int64_t)samples * 1000000 / SAMPLE_RATE);
+}
+
+// Accumulate timing stats for a single beat.
+static void RecordBeatJitter(const BeatEvent *event)
+{
+   LOG_EVENT("beat = %x, lateness = %d us",
+             event->beat,
+             SamplesToMicroseconds(event->lateness));
+   if( g_beat_count == 0 || g_beat_min_lateness > event->lateness )
+      g_beat_min_lateness = event->lateness;
+   if( g_beat_count == 0 || g_beat_max_lateness < event->lateness )
+      g_beat_max_lateness = event->lateness;
+   g_beat_total_error += abs(event->lateness);
+   g_beat_count++;
+}
+
+// Log beat timing stats and reset counters.
+static void ReportBeatJitter(void)
+{
+   if( g_beat_count > 0 )
+   {
+      LOG_EVENT("beat jitter: %d beats, min = %d us, max = %d us, "
+                "mean error = %d us",
+                g_beat_count,
+                SamplesToMicroseconds(g_beat_min_lateness),
+                SamplesToMicroseconds(g_beat_max_lateness),
+                SamplesToMicroseconds(g_beat_total_error / g_beat_count));
+   }
+   g_beat_count = 0;
+}
+#else
+   #define RecordBeatJitter(event)
+   #define ReportBeatJitter()
+#endif
+
+#if ENABLE_REPLAY
+// Start playing back the loaded replay, if there is one.  World is reset
+// with the replay seed, same as ResetSimulation in host/simulation.c, so
+// that platform generation matches the recording.
+static void StartReplay(PlaydateAPI *pd)
+{
+   if( !HasPlayback() )
+      return;
+   srand(GetPlaybackSeed());
+   ResetWorld(&g_world);
+   g_world.disable_meteors = 0;
+   g_replay_frame = 0;
+   pd->system->logToConsole("replay: playing seed %u", GetPlaybackSeed());
+}
+
+// Get song beat for a replay frame, in the same format as GetSongBeat.
+// Replays follow the frame count instead of the audio clock, same as
+// StepSimulation in host/simulation.c.
+static int GetReplayBeat(int frame)
+{
+   return GetSongBeatAtTime((uint32_t)frame * (SAMPLE_RATE / SIMULATION_RATE));
+}
+
+#define IsReplaying()  (g_replay_frame >= 0)
+#else
+   #define StartReplay(pd)
+   #define GetReplayBeat(frame)  0
+   #define IsReplaying()         0
+#endif
+
 // Reset game to title screen.
 static void Reset(void *userdata)
 {
    PlaydateAPI *pd = userdata;
 
+   ReportIdleFrames(pd);
+   ReportBeatJitter();
+
+   // Games that reach game over report refresh rates there, this covers
+   // games that were reset from the menu while in progress.
+   if( g_game_state == kGameInProgress )
+      ReportRefreshRate(pd);
    StopBackgroundMusic(pd);
+   ResetRefreshRate(pd);
+   #if ENABLE_TRACE
+      CloseTrace(pd);
+   #endif
+   #if ENABLE_REPLAY
+      g_replay_frame = -1;
+   #endif
    g_game_state = kTitleScreen;
+   g_force_redraw = 1;
+   g_upcoming_style = kPlatformTrees;
    ResetWorld(&g_world);
 }
 
@@ -151,13 +373,19 @@ static void SetControlMode(void *userdata)
       g_accelerometer_state = kAccelerometerStarting;
    else
       g_accelerometer_state = kAccelerometerStopping;
+   g_force_redraw = 1;
 }
 
 // Toggle falling meteors.
 static void ToggleMeteors(void *userdata)
 {
    PlaydateAPI *pd = userdata;
+
+   // Replays assume meteors are enabled, see playback.h.
+   if( IsReplaying() )
+      return;
    g_world.disable_meteors = !(pd->system->getMenuItemValue(g_meteor_enabled));
+   g_force_redraw = 1;
 }
 
 // Read direction based on mode config.
@@ -201,9 +429,56 @@ static int GetDirection(PlaydateAPI *pd)
    return angle;
 }
 
-// Update and draw the world in title screen state.
-static void UpdateTitleScreen(PlaydateAPI *pd)
+#ifndef NDEBUG
+// Input latency probe state.  When a button is pressed while slime is at
+// rest, we record the frame number, and measure the number of frames until
+// the first drawn frame where the slime has left the ground.
+static int g_frame_number = 0;
+static int g_latency_probe_start = -1;
+
+// Start or cancel latency measurement based on button state.
+static void UpdateLatencyProbe(PDButtons pushed, PDButtons released)
 {
+   g_frame_number++;
+   if( (pushed & ANY_BUTTON) != 0 && g_world.slime.in_flight_time == 0 )
+      g_latency_probe_start = g_frame_number;
+   else if( (released & ANY_BUTTON) != 0 )
+      g_latency_probe_start = -1;
+}
+
+// Check if the effect of the button press has become visible.  This is
+// called after the world has been drawn.
+static void CheckLatencyProbe(PlaydateAPI *pd)
+{
+   if( g_latency_probe_start < 0 || g_world.slime.in_flight_time == 0 )
+      return;
+   LOG_EVENT("input latency: %d frames",
+             g_frame_number - g_latency_probe_start);
+   g_latency_probe_start = -1;
+}
+#else
+   #define UpdateLatencyProbe(pushed, released)
+   #define CheckLatencyProbe(pd)
+#endif
+
+// Update and draw the world in title screen state.  Returns 1 if screen
+// was updated.
+static int UpdateTitleScreen(PlaydateAPI *pd)
+{
+   // Start/stop accelerometer in response to menu changes.
+   (void)GetDirection(pd);
+
+   // Skip this frame if there are no input and nothing would move.
+   PDButtons current, pushed, released;
+   pd->system->getButtonState(&current, &pushed, &released);
+   if( g_force_redraw == 0 &&
+       ((current | pushed) & ANY_BUTTON) == 0 &&
+       IsWorldAtRest(&g_world) )
+   {
+      return 0;
+   }
+   g_force_redraw = 0;
+
    // Update and draw world.  Update needs to run for at least one
    // frame to get the world populated.  All updates after that will
    // be mostly no-op since we are not accepting input yet.  (Mostly,
@@ -214,7 +489,7 @@ static void UpdateTitleScreen(PlaydateAPI *pd)
    // Show title logo and other info text.
    pd->graphics->drawBitmap(g_title, 32, 20, kBitmapUnflipped);
 
-   DrawBoxedText(pd, "press A to start", 130, 180);
+   pd->graphics->drawBitmap(g_start_prompt, 130, 180, kBitmapUnflipped);
 
    pd->graphics->setDrawMode(kDrawModeFillWhite);
    static const char kInfo1[] = "PlayJam 8 \"Ascension\"";
@@ -223,26 +498,69 @@ static void UpdateTitleScreen(PlaydateAPI *pd)
    pd->graphics->drawText(kInfo2, strlen(kInfo2), kASCIIEncoding, 267, 220);
    pd->graphics->setDrawMode(kDrawModeCopy);
 
-   // Start/stop accelerometer in response to menu changes.
-   (void)GetDirection(pd);
-
    // Handle input.
-   PDButtons current, pushed, released;
-   pd->system->getButtonState(&current, &pushed, &released);
    if( (pushed & ANY_BUTTON) != 0 )
    {
+      ReportIdleFrames(pd);
+      ResetRefreshRate(pd);
+      #if ENABLE_PROFILE
+         ResetProfileStats();
+      #endif
+      #if ENABLE_TRACE
+         OpenTrace(pd);
+      #endif
+      StartReplay(pd);
       g_game_state = kGameInProgress;
       PlayBackgroundMusic(pd);
    }
+   return 1;
 }
 
 // Update the world while game is in progress.
 static void UpdateGameInProgress(PlaydateAPI *pd)
 {
+   // Sample input before running world updates, so that input takes
+   // effect in the same frame.
+   PDButtons current, pushed, released;
+   pd->system->getButtonState(&current, &pushed, &released);
+   unsigned int angle = GetDirection(pd);
+
+   // When control is in crank mode, slime jumps on button press, and
+   // will jump continuously if button is held.
+   //
+   // When control is in tilt mode, slime behaves as if the buttons are
+   // permanently held, and will jump continuously.
+   //
+   // Buttons pushed since the previous frame are included, so that a tap
+   // that was released before this frame still causes a jump.  At lowered
+   // refresh rates, frames are far enough apart for that to happen, and
+   // missing the tap would also leave the refresh rate lowered.
+   int jump = g_accelerometer_state == kAccelerometerEnabled ||
+              ((current | pushed) & ANY_BUTTON) != 0;
+   #if ENABLE_REPLAY
+      if( IsReplaying() )
+         GetPlaybackInput(g_replay_frame, &angle, &jump);
+   #endif
+   const int has_input = jump || angle != g_world.slime.a;
+   UpdateLatencyProbe(pushed, released);
+
    // Synchronize beats and also determine game over condition.
-   const int beat = GetSongBeat(pd);
+   const int beat = IsReplaying() ? GetReplayBeat(g_replay_frame)
+                                  : GetSongBeat(pd);
+
+   // Drain beat events.  World updates only depend on the current beat, the
+   // events are only used for timing stats in debug builds.
+   BeatEvent beat_event;
+   while( PopBeatEvent(&beat_event) )
+      RecordBeatJitter(&beat_event);
    g_world.beat = beat & 0xffff;
    assert((beat >> 16) >= g_world.platform_style);
+   const int upcoming_phase =
+      IsReplaying()
+         ? GetReplayBeat(g_replay_frame + REPLAY_PHASE_LOOK_AHEAD) >> 16
+         : GetUpcomingSongPhase(pd);
+   if( upcoming_phase <= kPlatformSpace )
+      g_upcoming_style = (PlatformStyle)upcoming_phase;
    switch( beat >> 16 )
    {
       case 0: g_world.platform_style = kPlatformTrees; break;
@@ -259,7 +577,7 @@ static void UpdateGameInProgress(PlaydateAPI *pd)
                   if( g_world.platform[i].vx != 0 )
                      movable_platforms++;
                }
-               pd->system->logToConsole(
+               LOG_EVENT(
                   "world: platform_cursor=%d, platform_limit=%d, ceiling=%d, "
                   "scroll_offset_y=%d, meteor_start=%d, meteor_end=%d, "
                   "spring_limit=%d, movable_platforms=%d",
@@ -271,7 +589,7 @@ static void UpdateGameInProgress(PlaydateAPI *pd)
                   g_world.meteor_end,
                   g_world.spring_limit,
                   movable_platforms);
-               pd->system->logToConsole(
+               LOG_EVENT(
                   "slime: xy=(%d,%d), vxy=(%d,%d), peak=%d, max_fall=%d",
                   g_world.slime.x,
                   g_world.slime.y,
@@ -281,56 +599,127 @@ static void UpdateGameInProgress(PlaydateAPI *pd)
                   g_world.slime.max_fall);
             }
          #endif
+         ReportRefreshRate(pd);
+         ResetRefreshRate(pd);
+         ReportBeatJitter();
+         ReportSoundEffects();
+         ReportWorldImages();
+         ReportWorldMemory();
+         ReportImageLoads();
+         ReportHeap();
+
+         // The remaining reports write to console directly, so flush
+         // pending entries first to keep the log in order.
+         FlushLog(pd, LOG_RING_SIZE);
+         ReportImageMemory(pd->system->logToConsole);
+         #if ENABLE_PROFILE
+            ReportProfile(pd->system->logToConsole);
+         #endif
+         #if ENABLE_TRACE
+            CloseTrace(pd);
+         #endif
          g_game_state = kGameOver;
+         g_force_redraw = 1;
          break;
    }
 
-   // Update and draw world.
-   UpdateWorld(&g_world);
-   DrawWorld(&g_world, pd);
-
-   // Handle input.
-   g_world.slime.a = GetDirection(pd);
-   if( g_accelerometer_state != kAccelerometerEnabled )
+   // Apply input and update world.  If refresh rate has been lowered, we
+   // will run multiple updates per frame so that the world moves at the
+   // same speed as before.
+   //
+   // Input is applied before each update, so each JumpSlime call is
+   // followed by exactly one UpdateSlime call.  This preserves the
+   // behavior of JumpSlime accepting extra vertical velocity while the
+   // button is held during the first few frames of a jump.
+   //
+   // Replays keep the full refresh rate (see UpdateRefreshRate call
+   // below), so that each frame runs exactly one update with one recorded
+   // input.
+   const int steps = GetSimulationSteps();
+   assert(!IsReplaying() || steps == 1);
+   g_world.slime.events = 0;
+   for(int i = 0; i < steps; i++)
    {
-      // When control is in crank mode, slime jumps on button press, and
-      // will jump continuously if button is held.
-      PDButtons current, pushed, released;
-      pd->system->getButtonState(&current, &pushed, &released);
-      if( (current & ANY_BUTTON) != 0 )
+      g_world.slime.a = angle;
+      if( jump )
          JumpSlime(&(g_world.slime));
+      UpdateWorld(&g_world);
    }
-   else
-   {
-      // When control is in tilt mode, slime behaves as if the buttons are
-      // permanently held, and will jump continuously.
-      JumpSlime(&(g_world.slime));
-   }
+   #if ENABLE_REPLAY
+      if( IsReplaying() )
+         g_replay_frame++;
+   #endif
+   DrawWorld(&g_world, pd);
+   CheckLatencyProbe(pd);
+
+   // Play sound effects for everything that happened to the slime in this
+   // frame.  If multiple steps were run, repeated events are merged.
+   PlaySlimeSoundEffects(pd, g_world.slime.events);
+   #if SFX_STRESS_TEST
+      // Trigger every sound effect several times per frame, to verify that
+      // voice stealing doesn't cause stutters or frame time spikes.
+      for(int i = 0; i < SFX_STRESS_TEST; i++)
+      {
+         for(int j = 0; j < kSfxCount; j++)
+            PlaySoundEffect(pd, (SoundEffect)j);
+      }
+   #endif
+   #if ENABLE_TRACE
+      WriteTrace(pd, &g_world, beat, steps);
+   #endif
+
+   // Lower refresh rate if nothing is moving.
+   if( g_game_state == kGameInProgress )
+      UpdateRefreshRate(pd, !has_input && !IsReplaying() &&
+                            IsWorldAtRest(&g_world));
+
+   // Write a few log entries if we are running at a lowered refresh rate,
+   // since that means we have time to spare.
+   if( steps > 1 )
+      FlushLog(pd, LOG_FLUSH_BATCH_SIZE);
 }
 
 // Show a single line of stats for game over screen.
 static void ShowSlimeStat(PlaydateAPI *pd,
-                          const char *template,
-                          int fixe_point_value,
+                          HudNumber *stat,
+                          int fixed_point_value,
                           int y)
 {
-   char *text = NULL;
-   pd->system->formatString(
-      &text, template, fixe_point_value >> SLIME_FRACTION_BITS);
-   DrawBoxedText(pd, text, 10, y);
-   pd->system->realloc(text, 0);
+   DrawHudNumber(stat,
+                 fixed_point_value >> SLIME_FRACTION_BITS,
+                 kHudBoxed,
+                 10, y, pd);
 }
 
-// Draw the world without updates when game is over.
-static void UpdateGameOver(PlaydateAPI *pd)
+// Draw the world without updates when game is over.  Returns 1 if screen
+// was updated.
+static int UpdateGameOver(PlaydateAPI *pd)
 {
+   // Start/stop accelerometer in response to menu changes.
+   (void)GetDirection(pd);
+
+   // Handle input.
+   PDButtons current, pushed, released;
+   pd->system->getButtonState(&current, &pushed, &released);
+   if( (pushed & ANY_BUTTON) != 0 )
+   {
+      Reset(pd);
+      return 0;
+   }
+
+   // Nothing changes on this screen apart from menu changes, so we only
+   // need to draw the first frame.
+   if( g_force_redraw == 0 )
+      return 0;
+   g_force_redraw = 0;
+
    // Draw world without updates.
    DrawWorld(&g_world, pd);
 
    // Show stats and "return to title" text.
-   ShowSlimeStat(pd, "Final height %d", -g_world.slime.y, 15);
-   ShowSlimeStat(pd, "Peak height %d", -g_world.slime.peak, 47);
-   ShowSlimeStat(pd, "Longest free fall %d", g_world.slime.max_fall, 79);
+   ShowSlimeStat(pd, &g_final_height, -g_world.slime.y, 15);
+   ShowSlimeStat(pd, &g_peak_height, -g_world.slime.peak, 47);
+   ShowSlimeStat(pd, &g_longest_fall, g_world.slime.max_fall, 79);
 
    static const char kReturnToTitle[] = "press A to return to title";
    pd->graphics->fillRect(198, 215, 202, 25, kColorBlack);
@@ -338,15 +727,25 @@ static void UpdateGameOver(PlaydateAPI *pd)
    pd->graphics->drawText(kReturnToTitle, strlen(kReturnToTitle),
                           kASCIIEncoding, 208, 220);
    pd->graphics->setDrawMode(kDrawModeCopy);
+   return 1;
+}
 
-   // Start/stop accelerometer in response to menu changes.
-   (void)GetDirection(pd);
+// Load remaining world images, one per frame.
+static void LoadPendingImages(PlaydateAPI *pd)
+{
+   if( g_images_loaded )
+      return;
+   g_images_loaded = LoadPendingWorldImages(pd);
 
-   // Handle input.
-   PDButtons current, pushed, released;
-   pd->system->getButtonState(&current, &pushed, &released);
-   if( (pushed & ANY_BUTTON) != 0 )
-      Reset(pd);
+   #ifndef NDEBUG
+      if( g_images_loaded )
+      {
+         LOG_EVENT("startup: all images loaded after %d ms",
+                   (int)(pd->system->getCurrentTimeMilliseconds() -
+                         g_init_start_time));
+         ReportImageLoads();
+      }
+   #endif
 }
 
 // Draw a single frame.
@@ -354,15 +753,63 @@ static int Update(void *userdata)
 {
    PlaydateAPI *pd = userdata;
 
+   #if ENABLE_PROFILE
+      BeginProfileFrame();
+   #endif
+
+   // Transient buffers from previous frame are no longer needed, and heap
+   // allocations are not expected while the game is in progress.
+   ResetFrameArena();
+   SetHeapGuard(g_game_state == kGameInProgress);
+
+   LoadPendingImages(pd);
+   UpdateWorldImages(&g_world, g_upcoming_style, pd);
+
+   int updated = 1;
    switch( g_game_state )
    {
-      case kTitleScreen:    UpdateTitleScreen(pd);    break;
-      case kGameInProgress: UpdateGameInProgress(pd); break;
-      case kGameOver:       UpdateGameOver(pd);       break;
+      case kTitleScreen:    updated = UpdateTitleScreen(pd); break;
+      case kGameInProgress: UpdateGameInProgress(pd);        break;
+      case kGameOver:       updated = UpdateGameOver(pd);    break;
+   }
+
+   #ifndef NDEBUG
+      if( g_game_state != kGameInProgress )
+      {
+         g_static_screen_frames++;
+         if( !updated )
+            g_idle_frames++;
+      }
+   #endif
+
+   // Don't update display if nothing was drawn.  Returning zero here tells
+   // the system that the frame buffer is unchanged.  We also use these
+   // idle frames to write pending log entries.
+   //
+   // Background music is prepared on the first idle title screen frame
+   // after a reset, instead of in Reset itself, since Reset runs from the
+   // menu callback or a button press on a frame that is drawn.  If the
+   // game starts before then, PlayBackgroundMusic prepares it instead.
+   if( !updated )
+   {
+      if( g_game_state == kTitleScreen )
+         PrepareBackgroundMusic(pd);
+      FlushLog(pd, LOG_RING_SIZE);
+      return 0;
    }
 
    #ifndef NDEBUG
       pd->system->drawFPS(0, 0);
+      if( !g_first_frame_drawn )
+      {
+         g_first_frame_drawn = 1;
+         LOG_EVENT("startup: first frame after %d ms",
+                   (int)(pd->system->getCurrentTimeMilliseconds() -
+                         g_init_start_time));
+      }
+   #endif
+   #if ENABLE_PROFILE_GRAPH
+      DrawProfileGraph(pd);
    #endif
    pd->graphics->markUpdatedRows(0, LCD_ROWS - 1);
    return 1;
@@ -382,15 +829,18 @@ int eventHandler(PlaydateAPI *pd, PDSystemEvent event, uint32_t unused_arg)
    switch( event )
    {
       case kEventInit:
-         #if TARGET_PLAYDATE
          #ifndef NDEBUG
-            g_pd = pd;
-         #endif
+            g_init_start_time = pd->system->getCurrentTimeMilliseconds();
          #endif
+         MeasureLogOverhead(pd);
          srand(pd->system->getSecondsSinceEpoch(NULL));
+         #if ENABLE_PROFILE
+            SetProfileClock(pd->system->getElapsedTime,
+                            pd->system->resetElapsedTime);
+         #endif
 
          pd->system->setUpdateCallback(Update, pd);
-         pd->display->setRefreshRate(30);
+         pd->display->setRefreshRate(SIMULATION_RATE);
 
          pd->system->addMenuItem("reset", Reset, pd);
          g_control_mode = pd->system->addOptionsMenuItem(
@@ -404,16 +854,38 @@ int eventHandler(PlaydateAPI *pd, PDSystemEvent event, uint32_t unused_arg)
             "rocks", 1, ToggleMeteors, pd);
 
          LoadFont(pd);
+         LoadSoundEffects(pd);
+         LoadText(pd);
+         OpenImages(pd);
          LoadSlime(pd);
          LoadWorld(pd);
          LoadTitle(pd);
+         #if ENABLE_REPLAY
+            LoadPlayback(pd, REPLAY_PATH);
+         #endif
+         #if BGM_BENCHMARK
+            BenchmarkBackgroundMusic(pd);
+         #endif
          Reset(pd);
          break;
 
       case kEventPause:
          SetMenuImage(pd);
+         FlushLog(pd, LOG_RING_SIZE);
          break;
 
+      case kEventResume:
+         // Always redraw after the menu is dismissed, in case the menu
+         // changed something that affects the current screen.
+         g_force_redraw = 1;
+         break;
+
+      #if ENABLE_TRACE
+         case kEventTerminate:
+            CloseTrace(pd);
+            break;
+      #endif
+
       default:
          break;
    }
@@ -0,0 +1,114 @@
+#!/usr/bin/perl -w
+# Report static memory use of a device build.
+#
+# Usage:
+#
+#    perl memory_report.pl {game.map} [heap_size] [stack_size]
+#
+# Device builds use -ffunction-sections and -fdata-sections, so each
+# function and variable is in its own input section, and the linker map
+# lists the size of each one.  This script groups those by section type
+# and lists them from largest to smallest, so that we can see where RAM
+# is going (e.g. how much of .bss is World, which scales with
+# MAX_PLATFORMS).
+#
+# Heap and stack sizes are the values passed to the assembler in Makefile,
+# and are included in the output for reference.
+#
+# Heap use at runtime is not in the map.  For that, see ReportHeap (heap.h)
+# and ReportImageMemory (images.h), which are logged in debug builds when
+# each game ends.
+
+use strict;
+
+# Section types in output order.  Read-only data is placed in .text output
+# section by link_map.ld, but is listed separately here.
+my @types = qw(text rodata data bss);
+
+if( $#ARGV < 0 || $#ARGV > 2 )
+{
+   die "$0 {game.map} [heap_size] [stack_size]\n";
+}
+my ($map_file, $heap_size, $stack_size) = @ARGV;
+
+# Load sizes from linker map.  See hot_set_report.pl for map syntax.
+my %size = ();
+foreach my $type (@types)
+{
+   $size{$type} = {};
+}
+open my $map, "<$map_file" or die "$map_file: $!\n";
+my $in_memory_map = 0;
+my $pending_section = undef;
+while( my $line = <$map> )
+{
+   if( !$in_memory_map )
+   {
+      $in_memory_map = 1 if $line =~ /^Linker script and memory map/;
+      next;
+   }
+   last if $line =~ /^Cross Reference Table/;
+
+   my ($section, $length, $file);
+   if( $line =~ /^ (\.\S+)\s+0x[[:xdigit:]]+\s+0x([[:xdigit:]]+)\s+(\S.*)$/ )
+   {
+      ($section, $length, $file) = ($1, hex($2), $3);
+   }
+   elsif( $line =~ /^ (\.\S+)$/ )
+   {
+      $pending_section = $1;
+      next;
+   }
+   elsif( defined($pending_section) &&
+          $line =~ /^\s+0x[[:xdigit:]]+\s+0x([[:xdigit:]]+)\s+(\S.*)$/ )
+   {
+      ($section, $length, $file) = ($pending_section, hex($1), $2);
+   }
+   $pending_section = undef;
+   next unless defined $section && $length > 0;
+
+   # Get section type and symbol name.  Sections without a symbol name
+   # (e.g. ".bss" from library objects) are named after their file.
+   next unless $section =~ /^\.(text|rodata|data|bss)(?:\.(.*))?$/;
+   my ($type, $name) = ($1, $2);
+   if( !defined($name) || $name eq "" )
+   {
+      $file =~ s/^.*[\/\\]//;
+      $name = "($file)";
+   }
+   else
+   {
+      # Merge clones and LTO-renamed copies with the original symbol,
+      # e.g. "Min.constprop.0" or "kTable.lto_priv.0".
+      $name =~ s/\..*$//;
+   }
+   $size{$type}{$name} += $length;
+}
+close $map;
+
+my $static_total = 0;
+my $ram_total = 0;
+foreach my $type (@types)
+{
+   my $section_size = $size{$type};
+   my $total = 0;
+   $total += $_ foreach values %$section_size;
+   $static_total += $total;
+   $ram_total += $total if $type eq "data" || $type eq "bss";
+
+   print ".$type: $total bytes\n";
+   foreach my $name (sort {$$section_size{$b} <=> $$section_size{$a} or
+                           $a cmp $b} keys %$section_size)
+   {
+      printf "   %8d  %s\n", $$section_size{$name}, $name;
+   }
+}
+print "Total: $static_total bytes, .data + .bss = $ram_total bytes\n";
+if( defined $heap_size )
+{
+   print "Heap size: $heap_size bytes\n";
+}
+if( defined $stack_size )
+{
+   print "Stack size: $stack_size bytes\n";
+}
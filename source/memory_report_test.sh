@@ -0,0 +1,83 @@
+#!/bin/bash
+
+if [[ $# -ne 1 ]]; then
+   echo "$0 {memory_report.pl}"
+   exit 1
+fi
+TOOL=$1
+
+set -euo pipefail
+MAP=$(mktemp)
+EXPECTED_OUTPUT=$(mktemp)
+ACTUAL_OUTPUT=$(mktemp)
+
+function die
+{
+   echo "$1"
+   rm -f "$MAP" "$EXPECTED_OUTPUT" "$ACTUAL_OUTPUT"
+   exit 1
+}
+
+# ................................................................
+
+# Sections listed before the memory map and in the cross reference table
+# should be ignored, as are empty sections and output section headers.
+cat <<EOT > "$MAP"
+Discarded input sections
+
+ .bss.g_unused  0x00000000      0x999 unused.o
+
+Linker script and memory map
+
+.text           0x00000000     0x1000
+ *(.text.*)
+ .text.UpdateWorld
+                0x00000000      0x100 /tmp/cc.ltrans0.ltrans.o
+                0x00000000                UpdateWorld
+ .text.Min      0x00000100       0x10 /tmp/cc.ltrans0.ltrans.o
+ .text.Min.constprop.0
+                0x00000110        0x8 /tmp/cc.ltrans0.ltrans.o
+ .text          0x00000118        0x0 /lib/crti.o
+ .rodata.kGrayLevel
+                0x00000120        0x4 /tmp/cc.ltrans0.ltrans.o
+
+.data           0x00001000       0x20
+ .data.g_state  0x00001000       0x10 /tmp/cc.ltrans1.ltrans.o
+ .data          0x00001010       0x10 /usr/lib/libc.a(lib_a-impure.o)
+
+.bss            0x00001020     0x9000
+ .bss.g_world   0x00001020     0x8000 /tmp/cc.ltrans1.ltrans.o
+ .bss.g_log_ring
+                0x00009020      0x800 /tmp/cc.ltrans1.ltrans.o
+
+Cross Reference Table
+
+ .bss.g_world   0x00000000     0x9999 unused.o
+EOT
+
+cat <<EOT > "$EXPECTED_OUTPUT"
+.text: 280 bytes
+        256  UpdateWorld
+         24  Min
+.rodata: 4 bytes
+          4  kGrayLevel
+.data: 32 bytes
+         16  (libc.a(lib_a-impure.o))
+         16  g_state
+.bss: 34816 bytes
+      32768  g_world
+       2048  g_log_ring
+Total: 35132 bytes, .data + .bss = 34848 bytes
+Heap size: 1000 bytes
+Stack size: 200 bytes
+EOT
+
+perl "$TOOL" "$MAP" 1000 200 > "$ACTUAL_OUTPUT"
+if ! ( diff "$EXPECTED_OUTPUT" "$ACTUAL_OUTPUT" ); then
+   die "Output mismatched"
+fi
+
+# ................................................................
+# Cleanup.
+rm -f "$MAP" "$EXPECTED_OUTPUT" "$ACTUAL_OUTPUT"
+exit 0
@@ -0,0 +1,146 @@
+#include"playback.h"
+#include<string.h>
+#include"bgm.h"
+#include"common.h"
+#include"refresh.h"
+
+// Maximum number of frames in a replay, same as SIMULATION_FRAMES in
+// host/simulation.h.
+#define PLAYBACK_FRAMES  ((int)(SONG_LENGTH / (SAMPLE_RATE / SIMULATION_RATE)))
+
+// Bit in g_input that holds the jump button state.  Lower bits hold the
+// angle, which is always less than 360.
+#define PLAYBACK_JUMP_BIT  0x8000
+
+// Seed for the loaded replay.
+static unsigned int g_seed = 0;
+
+// Number of recorded frames, or -1 if no replay has been loaded.
+static int g_frame_count = -1;
+
+// Recorded inputs, one per frame.
+static uint16_t g_input[PLAYBACK_FRAMES];
+
+// Parse an unsigned decimal number, skipping leading spaces.  Returns
+// pointer to the character after the number, or NULL if there was no
+// number.
+static const char *ParseNumber(const char *p, unsigned int *value)
+{
+   while( *p == ' ' || *p == '\t' )
+      p++;
+   if( *p < '0' || *p > '9' )
+      return NULL;
+   *value = 0;
+   for(; *p >= '0' && *p <= '9'; p++)
+      *value = *value * 10 + (*p - '0');
+   return p;
+}
+
+// Parse a single line of replay text.  Returns 0 on success.
+static int ParseLine(const char *line)
+{
+   if( *line == '#' || *line == '\n' || *line == '\r' || *line == '\0' )
+      return 0;
+
+   if( g_frame_count < 0 )
+   {
+      static const char kSeed[] = "seed ";
+      if( strncmp(line, kSeed, sizeof(kSeed) - 1) != 0 ||
+          ParseNumber(line + sizeof(kSeed) - 1, &g_seed) == NULL )
+      {
+         return 1;
+      }
+      g_frame_count = 0;
+      return 0;
+   }
+
+   unsigned int angle, jump, count = 1;
+   const char *p = ParseNumber(line, &angle);
+   if( p == NULL || (p = ParseNumber(p, &jump)) == NULL )
+      return 1;
+   if( ParseNumber(p, &count) == NULL )
+      count = 1;
+   if( angle >= 360 || count == 0 ||
+       count > (unsigned int)(PLAYBACK_FRAMES - g_frame_count) )
+   {
+      return 1;
+   }
+   const uint16_t input = angle | (jump != 0 ? PLAYBACK_JUMP_BIT : 0);
+   for(; count > 0; count--)
+      g_input[g_frame_count++] = input;
+   return 0;
+}
+
+// Load replay from file.
+int LoadPlayback(PlaydateAPI *pd, const char *path)
+{
+   g_frame_count = -1;
+
+   FileStat stat;
+   SDFile *infile = pd->file->stat(path, &stat) == 0
+                    ? pd->file->open(path, kFileRead | kFileReadData)
+                    : NULL;
+   if( infile == NULL )
+   {
+      pd->system->logToConsole("replay: %s: %s", path, pd->file->geterr());
+      return 1;
+   }
+
+   // Replay files are small (a few KB for a full game), so the whole file
+   // is read at once.  This only happens during setup.
+   char *text = pd->system->realloc(NULL, stat.size + 1);
+   assert(text != NULL);
+   const int size = pd->file->read(infile, text, stat.size);
+   pd->file->close(infile);
+   int error = size != (int)stat.size;
+   if( !error )
+   {
+      text[size] = '\0';
+      for(char *line = text; *line != '\0' && !error;)
+      {
+         char *end = strchr(line, '\n');
+         if( end != NULL )
+            *end++ = '\0';
+         else
+            end = line + strlen(line);
+         error = ParseLine(line);
+         line = end;
+      }
+   }
+   pd->system->realloc(text, 0);
+
+   if( error || g_frame_count < 0 )
+   {
+      pd->system->logToConsole("replay: %s: invalid replay", path);
+      g_frame_count = -1;
+      return 1;
+   }
+   pd->system->logToConsole("replay: loaded %s, seed = %u, frames = %d",
+                            path, g_seed, g_frame_count);
+   return 0;
+}
+
+// Check if replay has been loaded.
+int HasPlayback(void)
+{
+   return g_frame_count >= 0;
+}
+
+// Get replay seed.
+unsigned int GetPlaybackSeed(void)
+{
+   return g_seed;
+}
+
+// Get input for a frame.
+void GetPlaybackInput(int frame, unsigned int *angle, int *jump)
+{
+   if( frame >= 0 && frame < g_frame_count )
+   {
+      *angle = g_input[frame] & ~PLAYBACK_JUMP_BIT;
+      *jump = (g_input[frame] & PLAYBACK_JUMP_BIT) != 0;
+      return;
+   }
+   *angle = 0;
+   *jump = 0;
+}
@@ -0,0 +1,35 @@
+// Library for playing back recorded game inputs on the device.
+//
+// Host tools such as worst_frame.exe save replays in the text format
+// described in host/replay.h.  When compiled with -DENABLE_REPLAY=1 (see
+// "REPLAY" variable in Makefile), the game loads "replay.txt" from the data
+// folder at startup, and every game started from the title screen is
+// played with the recorded inputs instead of buttons and crank.  World
+// updates are then driven by frame count instead of the audio clock, the
+// same way as StepSimulation in host/simulation.h, so that the device runs
+// exactly the same sequence of world updates as the host tools.
+//
+// Replays assume falling meteors are enabled, so the "rocks" menu item is
+// ignored while a replay is playing.
+
+#ifndef PLAYBACK_H_
+#define PLAYBACK_H_
+
+#include"pd_api.h"
+
+// Load replay from file.  Returns 0 on success.  On failure, the reason is
+// logged to console and HasPlayback will return 0.
+int LoadPlayback(PlaydateAPI *pd, const char *path);
+
+// Returns 1 if a replay has been loaded.
+int HasPlayback(void);
+
+// Get seed for the loaded replay.
+unsigned int GetPlaybackSeed(void);
+
+// Get recorded input for a frame.  Frames after the last recorded frame
+// use default inputs (angle 0, jump button not held), same as
+// GetReplayInput in host/replay.h.
+void GetPlaybackInput(int frame, unsigned int *angle, int *jump);
+
+#endif  // PLAYBACK_H_
@@ -0,0 +1,203 @@
+#include"profile.h"
+#include<string.h>
+#include"common.h"
+
+// Graph dimensions.  Each frame is drawn as a 2 pixel wide bar, and each
+// pixel of height is worth GRAPH_SCALE microseconds.
+#define GRAPH_BAR_WIDTH    2
+#define GRAPH_WIDTH        (PROFILE_HISTORY * GRAPH_BAR_WIDTH)
+#define GRAPH_HEIGHT       72
+#define GRAPH_SCALE        500
+
+// Time budget for a single frame at 30fps, in microseconds.
+#define FRAME_BUDGET       33333
+
+// Section names.  These are used in both device and host reports.
+static const char *kSectionNames[kProfileSectionCount] =
+{
+   "generate",
+   "meteors",
+   "platforms",
+   "collision",
+   "background_color",
+   "draw_background",
+   "draw_platforms",
+   "draw_springs",
+   "draw_slime",
+   "draw_meteor",
+   "draw_hud",
+};
+
+// Clock functions.
+static float (*g_get_time)(void) = NULL;
+static void (*g_reset_time)(void) = NULL;
+
+// Ring buffer of section times for recent frames, in microseconds.
+static uint32_t g_history[PROFILE_HISTORY][kProfileSectionCount];
+
+// Index of current frame in g_history.
+static int g_current_frame = 0;
+
+// Accumulated stats since last report.
+static uint64_t g_total_time[kProfileSectionCount];
+static uint32_t g_max_time[kProfileSectionCount];
+static int g_frame_count = 0;
+
+// Nonzero if the current frame should not be added to accumulated stats.
+// This is set initially since there is no completed frame before the first
+// BeginProfileFrame call, and by ResetProfileStats.
+static int g_skip_frame = 1;
+
+// Set clock functions.
+void SetProfileClock(float (*get_time)(void), void (*reset_time)(void))
+{
+   g_get_time = get_time;
+   g_reset_time = reset_time;
+}
+
+// Start a new frame.
+void BeginProfileFrame(void)
+{
+   // Accumulate stats for the frame that just completed.
+   if( g_skip_frame )
+   {
+      g_skip_frame = 0;
+   }
+   else
+   {
+      const uint32_t *t = g_history[g_current_frame];
+      for(int i = 0; i < kProfileSectionCount; i++)
+      {
+         g_total_time[i] += t[i];
+         if( g_max_time[i] < t[i] )
+            g_max_time[i] = t[i];
+      }
+      g_frame_count++;
+   }
+
+   g_current_frame = (g_current_frame + 1) % PROFILE_HISTORY;
+   memset(g_history[g_current_frame], 0, sizeof(g_history[0]));
+
+   // Clock is reset on every frame, since float seconds would lose
+   // precision if we let the clock run for the whole game.
+   assert(g_reset_time != NULL);
+   g_reset_time();
+}
+
+// Get time since start of frame.
+uint32_t GetProfileTime(void)
+{
+   assert(g_get_time != NULL);
+   return (uint32_t)(g_get_time() * 1e6f);
+}
+
+// Add time to a section.
+void AddProfileTime(ProfileSection section, uint32_t microseconds)
+{
+   assert(section >= 0);
+   assert(section < kProfileSectionCount);
+   g_history[g_current_frame][section] += microseconds;
+}
+
+// Start a scoped timer.
+ProfileScope BeginProfileScope(ProfileSection section)
+{
+   ProfileScope scope;
+   scope.section = section;
+   scope.start = GetProfileTime();
+   return scope;
+}
+
+// Stop a scoped timer.
+void EndProfileScope(const ProfileScope *scope)
+{
+   AddProfileTime(scope->section, GetProfileTime() - scope->start);
+}
+
+// Get section name.
+const char *GetProfileSectionName(ProfileSection section)
+{
+   assert(section >= 0);
+   assert(section < kProfileSectionCount);
+   return kSectionNames[section];
+}
+
+// Get section times for a past frame.
+const uint32_t *GetProfileFrame(int age)
+{
+   assert(age >= 0);
+   assert(age < PROFILE_HISTORY);
+   return g_history[(g_current_frame + PROFILE_HISTORY - age) %
+                    PROFILE_HISTORY];
+}
+
+// Discard accumulated stats.
+void ResetProfileStats(void)
+{
+   memset(g_total_time, 0, sizeof(g_total_time));
+   memset(g_max_time, 0, sizeof(g_max_time));
+   g_frame_count = 0;
+   g_skip_frame = 1;
+}
+
+// Log accumulated stats.
+void ReportProfile(void (*log)(const char *format, ...))
+{
+   if( g_frame_count == 0 )
+      return;
+   log("profile: %d frames", g_frame_count);
+   for(int i = 0; i < kProfileSectionCount; i++)
+   {
+      log("profile: %s avg=%d max=%d",
+          kSectionNames[i],
+          (int)(g_total_time[i] / g_frame_count),
+          (int)g_max_time[i]);
+   }
+   memset(g_total_time, 0, sizeof(g_total_time));
+   memset(g_max_time, 0, sizeof(g_max_time));
+   g_frame_count = 0;
+}
+
+// Draw stacked bar graph.
+void DrawProfileGraph(PlaydateAPI *pd)
+{
+   // Alternate between solid and checkerboard fill, so that adjacent
+   // sections are distinguishable.
+   static const LCDPattern kCheckerboard =
+   {
+      0xaa, 0x55, 0xaa, 0x55, 0xaa, 0x55, 0xaa, 0x55,
+      0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff
+   };
+
+   const int x0 = SCREEN_WIDTH - GRAPH_WIDTH;
+   const int bottom = SCREEN_HEIGHT;
+   pd->graphics->fillRect(x0, bottom - GRAPH_HEIGHT,
+                          GRAPH_WIDTH, GRAPH_HEIGHT, kColorWhite);
+
+   // Draw bars with the most recent frame on the right.
+   for(int age = 0; age < PROFILE_HISTORY; age++)
+   {
+      const uint32_t *t = GetProfileFrame(age);
+      const int x = x0 + (PROFILE_HISTORY - 1 - age) * GRAPH_BAR_WIDTH;
+      uint32_t sum = 0;
+      int top = 0;
+      for(int i = 0; i < kProfileSectionCount; i++)
+      {
+         sum += t[i];
+         int new_top = sum / GRAPH_SCALE;
+         if( new_top > GRAPH_HEIGHT )
+            new_top = GRAPH_HEIGHT;
+         if( new_top > top )
+         {
+            pd->graphics->fillRect(
+               x, bottom - new_top, GRAPH_BAR_WIDTH, new_top - top,
+               (i & 1) != 0 ? (LCDColor)kCheckerboard : kColorBlack);
+            top = new_top;
+         }
+      }
+   }
+
+   // Draw a line to mark the frame budget.
+   pd->graphics->fillRect(x0, bottom - FRAME_BUDGET / GRAPH_SCALE,
+                          GRAPH_WIDTH, 1, kColorXOR);
+}
@@ -0,0 +1,101 @@
+// Library for measuring time spent in various parts of each frame.
+//
+// All functions here are only available when compiled with
+// -DENABLE_PROFILE=1, see "PROFILE" variable in Makefile.  Otherwise,
+// PROFILE_SCOPE expands to nothing, and the profiler has no runtime cost.
+//
+// This library doesn't depend on Playdate API apart from the graph overlay.
+// Host builds use the clock from host_api.c, and "make PROFILE=1
+// render_benchmark" prints the same report as ReportProfile on device.
+// Section names are shared by all builds, so that device and host profiles
+// can be compared line by line.
+
+#ifndef PROFILE_H_
+#define PROFILE_H_
+
+#include<stdint.h>
+
+#include"pd_api.h"
+
+// Number of frames to keep in history.
+#define PROFILE_HISTORY    64
+
+// Profiled sections.
+typedef enum
+{
+   kProfileGenerate,          // AppendSimpleChain + AppendPredefinedShape
+   kProfileMeteors,           // SpawnMeteors + AnimateMeteors
+   kProfilePlatforms,         // Moving platforms
+   kProfileCollision,         // Slime movement and collision
+   kProfileBackgroundColor,   // UpdateBackgroundColor
+   kProfileDrawBackground,    // DrawBackground
+   kProfileDrawPlatforms,     // DrawPlatforms
+   kProfileDrawSprings,       // DrawSprings
+   kProfileDrawSlime,         // DrawSlime
+   kProfileDrawMeteor,        // DrawMeteor
+   kProfileDrawHud,           // DrawHudNumber
+
+   kProfileSectionCount
+} ProfileSection;
+
+// State for a single scoped timer.
+typedef struct
+{
+   ProfileSection section;
+   uint32_t start;
+} ProfileScope;
+
+#if ENABLE_PROFILE
+   // Measure time from this statement to the end of the enclosing scope,
+   // and add it to the specified section for the current frame.
+   //
+   // This uses GCC's cleanup attribute to run EndProfileScope when the
+   // variable goes out of scope, so early returns are also measured.
+   #define PROFILE_SCOPE(section)                                  \
+      ProfileScope PROFILE_CONCAT(profile_scope_, __LINE__)        \
+         __attribute__((cleanup(EndProfileScope))) =               \
+            BeginProfileScope(section)
+   #define PROFILE_CONCAT(a, b)     PROFILE_CONCAT_IMPL(a, b)
+   #define PROFILE_CONCAT_IMPL(a, b)   a##b
+#else
+   #define PROFILE_SCOPE(section)
+#endif
+
+// Set clock functions.  get_time returns time in seconds since the last
+// call to reset_time.  On the device, these are getElapsedTime and
+// resetElapsedTime.
+void SetProfileClock(float (*get_time)(void), void (*reset_time)(void));
+
+// Start a new frame in history.  This also resets the clock.
+void BeginProfileFrame(void);
+
+// Get time in microseconds since start of current frame.
+uint32_t GetProfileTime(void);
+
+// Add time to a section for the current frame.
+void AddProfileTime(ProfileSection section, uint32_t microseconds);
+
+// Helper functions for PROFILE_SCOPE.
+ProfileScope BeginProfileScope(ProfileSection section);
+void EndProfileScope(const ProfileScope *scope);
+
+// Get name of a section.
+const char *GetProfileSectionName(ProfileSection section);
+
+// Get section times in microseconds for a past frame.  Age 0 is the current
+// frame, age 1 is the frame before that, and so on.
+const uint32_t *GetProfileFrame(int age);
+
+// Discard accumulated stats, including the current frame.  This is called
+// when a game starts, so that ReportProfile only covers frames of that
+// game, and not title screen or game over frames before it.
+void ResetProfileStats(void);
+
+// Log average and maximum time of each section since last reset, and reset
+// accumulated stats.
+void ReportProfile(void (*log)(const char *format, ...));
+
+// Draw stacked bar graph of the recent frames.
+void DrawProfileGraph(PlaydateAPI *pd);
+
+#endif  // PROFILE_H_
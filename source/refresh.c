@@ -0,0 +1,82 @@
+#include"refresh.h"
+#include"common.h"
+#include"log_ring.h"
+
+// Available refresh rates, from fastest to slowest.  All rates divide
+// SIMULATION_RATE evenly, so that each frame runs a whole number of
+// simulation steps.
+static const int kRefreshRates[] = {SIMULATION_RATE, 15, 10};
+#define REFRESH_RATE_COUNT \
+   ((int)(sizeof(kRefreshRates) / sizeof(kRefreshRates[0])))
+
+// Number of consecutive calm simulation steps before dropping to the next
+// slower refresh rate.
+#define CALM_STEPS_PER_LEVEL  15
+
+// Index into kRefreshRates for the current refresh rate.
+static int g_rate_index = 0;
+
+// Number of consecutive calm simulation steps observed.
+static int g_calm_steps = 0;
+
+// Number of frames drawn at each refresh rate.
+static int g_frame_count[REFRESH_RATE_COUNT];
+
+// Restore full refresh rate.
+void ResetRefreshRate(PlaydateAPI *pd)
+{
+   g_rate_index = 0;
+   g_calm_steps = 0;
+   memset(g_frame_count, 0, sizeof(g_frame_count));
+   pd->display->setRefreshRate(kRefreshRates[0]);
+}
+
+// Get number of simulation steps for the current frame.
+int GetSimulationSteps(void)
+{
+   assert(g_rate_index >= 0);
+   assert(g_rate_index < REFRESH_RATE_COUNT);
+   return SIMULATION_RATE / kRefreshRates[g_rate_index];
+}
+
+// Select refresh rate for the next frame.
+void UpdateRefreshRate(PlaydateAPI *pd, int calm)
+{
+   g_frame_count[g_rate_index]++;
+
+   int new_index = 0;
+   if( calm )
+   {
+      g_calm_steps += GetSimulationSteps();
+      new_index = g_calm_steps / CALM_STEPS_PER_LEVEL;
+      if( new_index >= REFRESH_RATE_COUNT )
+         new_index = REFRESH_RATE_COUNT - 1;
+   }
+   else
+   {
+      g_calm_steps = 0;
+   }
+
+   if( new_index != g_rate_index )
+   {
+      g_rate_index = new_index;
+      pd->display->setRefreshRate(kRefreshRates[g_rate_index]);
+   }
+}
+
+// Log time spent at each refresh rate.
+void ReportRefreshRate(PlaydateAPI *pd)
+{
+   #ifndef NDEBUG
+      for(int i = 0; i < REFRESH_RATE_COUNT; i++)
+      {
+         // Time is logged in tenths of a second.
+         const int t = g_frame_count[i] * 10 / kRefreshRates[i];
+         LOG_EVENT("refresh rate %d: %d frames, %d.%d seconds",
+                   kRefreshRates[i],
+                   g_frame_count[i],
+                   t / 10,
+                   t % 10);
+      }
+   #endif
+}
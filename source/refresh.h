@@ -0,0 +1,34 @@
+// Library for adjusting display refresh rate according to world activity.
+//
+// When nothing is moving, we can draw fewer frames without any visible
+// difference, which saves CPU time and battery.  World updates always run at
+// SIMULATION_RATE steps per second regardless of refresh rate, so lowering
+// the refresh rate means running multiple simulation steps per frame.
+
+#ifndef REFRESH_H_
+#define REFRESH_H_
+
+#include"pd_api.h"
+
+// Number of world updates per second.
+#define SIMULATION_RATE    30
+
+// Restore full refresh rate and reset time counters.
+void ResetRefreshRate(PlaydateAPI *pd);
+
+// Get number of simulation steps to run for the current frame.  This is
+// determined by the refresh rate that was in effect for the time elapsed
+// since the previous frame.
+int GetSimulationSteps(void);
+
+// Select refresh rate for the next frame.  Setting calm to nonzero means
+// the current frame had no input and no visible movement.  Refresh rate is
+// lowered gradually over consecutive calm frames, and restored to full rate
+// immediately on the first frame that is not calm.
+void UpdateRefreshRate(PlaydateAPI *pd, int calm);
+
+// Log amount of time spent at each refresh rate since last reset.  This is
+// a no-op in release builds.
+void ReportRefreshRate(PlaydateAPI *pd);
+
+#endif  // REFRESH_H_
@@ -1,6 +1,8 @@
 // Copied from PlaydateSDK/C_API/buildsupport/setup.c
 
 #include "pd_api.h"
+#include "heap.h"
+#include "log_ring.h"
 
 typedef int (PDEventHandler)(PlaydateAPI* playdate, PDSystemEvent event, uint32_t arg);
 
@@ -16,16 +18,53 @@ int eventHandlerShim(PlaydateAPI* playdate, PDSystemEvent event, uint32_t arg)
 	return eventHandler(playdate, event, arg);
 }
 
+// Forward calls to Playdate's realloc, counting them in debug builds (see
+// heap.h).  Allocations made while heap guard is set are also logged.
+static void* shimrealloc(void* ptr, size_t nbytes)
+{
+#ifdef NDEBUG
+	return pdrealloc(ptr, nbytes);
+#else
+	void* result = pdrealloc(ptr, nbytes);
+	if ( ptr == NULL )
+	{
+		if ( result == NULL )
+			return result;
+		g_heap_stats.allocations++;
+		g_heap_stats.live_blocks++;
+		if ( g_heap_stats.peak_live_blocks < g_heap_stats.live_blocks )
+			g_heap_stats.peak_live_blocks = g_heap_stats.live_blocks;
+	}
+	else if ( nbytes == 0 )
+	{
+		g_heap_stats.frees++;
+		g_heap_stats.live_blocks--;
+	}
+	else
+	{
+		g_heap_stats.reallocations++;
+	}
+	g_heap_stats.bytes_requested += (int)nbytes;
+	if ( g_heap_guard && nbytes != 0 )
+	{
+		g_heap_stats.guarded_allocations++;
+		LOG_EVENT("memory: heap allocation of %d bytes during game",
+		          (int)nbytes);
+	}
+	return result;
+#endif
+}
+
 #if TARGET_PLAYDATE
 
-void* _malloc_r(struct _reent* _REENT, size_t nbytes) { return pdrealloc(NULL,nbytes); }
-void* _realloc_r(struct _reent* _REENT, void* ptr, size_t nbytes) { return pdrealloc(ptr,nbytes); }
-void _free_r(struct _reent* _REENT, void* ptr ) { if ( ptr != NULL ) pdrealloc(ptr,0); }
+void* _malloc_r(struct _reent* _REENT, size_t nbytes) { return shimrealloc(NULL,nbytes); }
+void* _realloc_r(struct _reent* _REENT, void* ptr, size_t nbytes) { return shimrealloc(ptr,nbytes); }
+void _free_r(struct _reent* _REENT, void* ptr ) { if ( ptr != NULL ) shimrealloc(ptr,0); }
 
 #else
 
-void* malloc(size_t nbytes) { return pdrealloc(NULL,nbytes); }
-void* realloc(void* ptr, size_t nbytes) { return pdrealloc(ptr,nbytes); }
-void  free(void* ptr ) { if ( ptr != NULL ) pdrealloc(ptr,0); }
+void* malloc(size_t nbytes) { return shimrealloc(NULL,nbytes); }
+void* realloc(void* ptr, size_t nbytes) { return shimrealloc(ptr,nbytes); }
+void  free(void* ptr ) { if ( ptr != NULL ) shimrealloc(ptr,0); }
 
 #endif
@@ -0,0 +1,197 @@
+#include"sfx.h"
+#include"common.h"
+#include"log_ring.h"
+#include"slime.h"
+
+// Sample rate for all synthesized sounds.
+#define SFX_SAMPLE_RATE    22050
+
+// Convert duration in milliseconds to number of samples.
+#define MS_TO_SAMPLES(ms)  ((ms) * SFX_SAMPLE_RATE / 1000)
+
+// Peak amplitude for all sounds.  This is kept well below full scale so
+// that overlapping sounds and background music don't clip too badly.
+#define SFX_AMPLITUDE      6000
+
+// Waveform shapes.
+typedef enum
+{
+   kWaveSquare,
+   kWaveNoise
+} Waveform;
+
+// Parameters for a single synthesized sound.  Frequency sweeps linearly
+// from start to end, and amplitude decays linearly to zero.
+typedef struct
+{
+   Waveform waveform;
+   int start_frequency;
+   int end_frequency;
+   int duration_ms;
+} SoundParameters;
+
+static const SoundParameters kSoundParameters[kSfxCount] =
+{
+   {kWaveSquare, 300, 900, 80},     // kSfxJump
+   {kWaveNoise, 800, 200, 60},      // kSfxLand
+   {kWaveNoise, 3000, 500, 150},    // kSfxHit
+   {kWaveSquare, 200, 150, 40},     // kSfxSpringCompress
+   {kWaveSquare, 150, 1200, 200},   // kSfxSpringRelease
+};
+
+// Sample buffer for all sounds.  Size is the sum of all durations above.
+#define SFX_BUFFER_SIZE    MS_TO_SAMPLES(80 + 60 + 150 + 40 + 200)
+static int16_t g_sample_data[SFX_BUFFER_SIZE];
+
+// Sample handles, pointing into g_sample_data.
+static AudioSample *g_sample[kSfxCount];
+
+// Voice pool.
+static SamplePlayer *g_voice[SFX_VOICE_COUNT];
+
+// Sequence number of when each voice was last started, for finding the
+// oldest voice to steal.
+static unsigned int g_voice_start[SFX_VOICE_COUNT];
+static unsigned int g_play_count = 0;
+
+#ifndef NDEBUG
+// Usage stats since last report.
+static int g_sound_count = 0;
+static int g_steal_count = 0;
+#endif
+
+// Synthesize a single sound into buffer.
+static void Synthesize(const SoundParameters *p, int16_t *output, int size)
+{
+   // Noise uses its own generator so that sound synthesis does not affect
+   // the sequence of rand() values used for world generation.
+   uint32_t noise_state = 0x12345678;
+   int noise_value = 0;
+   int polarity = 1;
+
+   // Phase accumulator, in units of 1/SFX_SAMPLE_RATE of a cycle.
+   int phase = 0;
+   for(int i = 0; i < size; i++)
+   {
+      const int frequency = p->start_frequency +
+         (p->end_frequency - p->start_frequency) * i / size;
+      const int amplitude = SFX_AMPLITUDE * (size - i) / size;
+
+      // Advance phase, and note whether we completed half a cycle.
+      phase += frequency * 2;
+      const int half_cycle = phase >= SFX_SAMPLE_RATE;
+      if( half_cycle )
+         phase -= SFX_SAMPLE_RATE;
+
+      if( p->waveform == kWaveSquare )
+      {
+         if( half_cycle )
+            polarity = -polarity;
+         output[i] = polarity * amplitude;
+      }
+      else
+      {
+         // Sample-and-hold noise, with a new random level every half
+         // cycle.  Sweeping the frequency changes the noise color.
+         if( half_cycle )
+         {
+            noise_state = noise_state * 1664525 + 1013904223;
+            noise_value = (int)(noise_state >> 16) - 0x8000;
+         }
+         output[i] = noise_value * amplitude / 0x8000;
+      }
+   }
+}
+
+// Synthesize samples and allocate voices.
+void LoadSoundEffects(PlaydateAPI *pd)
+{
+   int16_t *output = g_sample_data;
+   for(int i = 0; i < kSfxCount; i++)
+   {
+      const int size = MS_TO_SAMPLES(kSoundParameters[i].duration_ms);
+      assert(output + size <= g_sample_data + SFX_BUFFER_SIZE);
+      Synthesize(&kSoundParameters[i], output, size);
+      g_sample[i] = pd->sound->sample->newSampleFromData(
+         (uint8_t*)output, kSound16bitMono, SFX_SAMPLE_RATE,
+         size * (int)sizeof(int16_t), 0);
+      assert(g_sample[i] != NULL);
+      output += size;
+   }
+   assert(output == g_sample_data + SFX_BUFFER_SIZE);
+
+   for(int i = 0; i < SFX_VOICE_COUNT; i++)
+   {
+      g_voice[i] = pd->sound->sampleplayer->newPlayer();
+      assert(g_voice[i] != NULL);
+      g_voice_start[i] = 0;
+   }
+}
+
+// Play a single sound effect.
+void PlaySoundEffect(PlaydateAPI *pd, SoundEffect effect)
+{
+   assert(effect >= 0);
+   assert(effect < kSfxCount);
+
+   // Find an idle voice, or steal the voice that was started earliest.
+   int v = -1;
+   int oldest = 0;
+   for(int i = 0; i < SFX_VOICE_COUNT; i++)
+   {
+      if( pd->sound->sampleplayer->isPlaying(g_voice[i]) == 0 )
+      {
+         v = i;
+         break;
+      }
+      if( g_voice_start[oldest] > g_voice_start[i] )
+         oldest = i;
+   }
+   if( v < 0 )
+   {
+      v = oldest;
+      pd->sound->sampleplayer->stop(g_voice[v]);
+      #ifndef NDEBUG
+         g_steal_count++;
+      #endif
+   }
+   #ifndef NDEBUG
+      g_sound_count++;
+   #endif
+
+   pd->sound->sampleplayer->setSample(g_voice[v], g_sample[effect]);
+   pd->sound->sampleplayer->play(g_voice[v], 1, 1.0f);
+   g_voice_start[v] = ++g_play_count;
+}
+
+// Play sound effects for slime events.
+void PlaySlimeSoundEffects(PlaydateAPI *pd, unsigned int events)
+{
+   if( LIKELY(events == 0) )
+      return;
+
+   // Hit takes priority over landing and jumping, since those would
+   // usually be caused by the hit.
+   if( (events & SLIME_EVENT_HIT) != 0 )
+      PlaySoundEffect(pd, kSfxHit);
+   else if( (events & SLIME_EVENT_LAND) != 0 )
+      PlaySoundEffect(pd, kSfxLand);
+   else if( (events & SLIME_EVENT_JUMP) != 0 )
+      PlaySoundEffect(pd, kSfxJump);
+
+   if( (events & SLIME_EVENT_SPRING_RELEASE) != 0 )
+      PlaySoundEffect(pd, kSfxSpringRelease);
+   else if( (events & SLIME_EVENT_SPRING_COMPRESS) != 0 )
+      PlaySoundEffect(pd, kSfxSpringCompress);
+}
+
+// Log usage stats.
+void ReportSoundEffects(void)
+{
+   #ifndef NDEBUG
+      LOG_EVENT("sfx: %d played, %d voices stolen",
+                g_sound_count, g_steal_count);
+      g_sound_count = 0;
+      g_steal_count = 0;
+   #endif
+}
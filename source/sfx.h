@@ -0,0 +1,41 @@
+// Library for sound effects.
+//
+// All samples are synthesized and all voices are allocated at load time,
+// so that triggering a sound effect never allocates memory or touches the
+// file system.  A fixed number of voices are available, and if all of them
+// are busy, the voice that started earliest is stopped and reused.
+
+#ifndef SFX_H_
+#define SFX_H_
+
+#include"pd_api.h"
+
+// Number of sound effects that can play simultaneously.
+#define SFX_VOICE_COUNT    4
+
+// Available sound effects.
+typedef enum
+{
+   kSfxJump,
+   kSfxLand,
+   kSfxHit,
+   kSfxSpringCompress,
+   kSfxSpringRelease,
+
+   kSfxCount
+} SoundEffect;
+
+// Synthesize samples and allocate voices.
+void LoadSoundEffects(PlaydateAPI *pd);
+
+// Play a single sound effect.
+void PlaySoundEffect(PlaydateAPI *pd, SoundEffect effect);
+
+// Play sound effects for a bitmask of SLIME_EVENT_* bits.
+void PlaySlimeSoundEffects(PlaydateAPI *pd, unsigned int events);
+
+// Log number of sound effects played and number of voices stolen since the
+// last report, and reset counters.  This is a no-op in release builds.
+void ReportSoundEffects(void);
+
+#endif  // SFX_H_
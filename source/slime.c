@@ -1,5 +1,8 @@
 #include"slime.h"
 #include"common.h"
+#include"images.h"
+#include"profile.h"
+#include"work_count.h"
 
 // Sprite offsets.
 #define BODY_OFFSET_X         (-32)
@@ -37,11 +40,8 @@ static const ShortXY kVelocityTable[] =
 // Load sprites.
 void LoadSlime(PlaydateAPI *pd)
 {
-   const char *error;
-   g_body = pd->graphics->loadBitmapTable("body", &error);
-   assert(g_body != NULL);
-   g_eyes = pd->graphics->loadBitmapTable("eyes", &error);
-   assert(g_eyes != NULL);
+   g_body = LoadImageTable(pd, "body");
+   g_eyes = LoadImageTable(pd, "eyes");
 
    #ifndef NDEBUG
       int count, cellswide;
@@ -61,22 +61,28 @@ void ResetSlime(Slime *slime)
    slime->y = 0;
    slime->a = 0;
    slime->frame = 0;
+   slime->in_flight_time = 0;
+   slime->stun = 0;
    slime->vx = 0;
    slime->vy = 0;
    slime->peak = 0;
    slime->fall_start = 0;
    slime->max_fall = 0;
+   slime->events = 0;
 }
 
 // Draw slime.
 void DrawSlime(const Slime *slime, int scroll_offset_y, PlaydateAPI *pd)
 {
+   PROFILE_SCOPE(kProfileDrawSlime);
+
    // Draw body.
    assert(g_body != NULL);
    LCDBitmap *body = pd->graphics->getTableBitmap(g_body, slime->frame);
    assert(body != NULL);
    const int x = slime->x >> SLIME_FRACTION_BITS;
    const int y = (slime->y >> SLIME_FRACTION_BITS) + scroll_offset_y;
+   COUNT_WORK(kWorkBlit, 3);
    pd->graphics->drawBitmap(body,
                             x + BODY_OFFSET_X,
                             y + BODY_OFFSET_Y,
@@ -101,6 +107,7 @@ void DrawSlime(const Slime *slime, int scroll_offset_y, PlaydateAPI *pd)
    // Wraparound.
    if( UNLIKELY(x <= 32) )
    {
+      COUNT_WORK(kWorkBlit, 3);
       pd->graphics->drawBitmap(body,
                                x + BODY_OFFSET_X + SCREEN_WIDTH,
                                y + BODY_OFFSET_Y,
@@ -116,6 +123,7 @@ void DrawSlime(const Slime *slime, int scroll_offset_y, PlaydateAPI *pd)
    }
    else if( UNLIKELY(x > SCREEN_WIDTH - 32) )
    {
+      COUNT_WORK(kWorkBlit, 3);
       pd->graphics->drawBitmap(body,
                                x + BODY_OFFSET_X - SCREEN_WIDTH,
                                y + BODY_OFFSET_Y,
@@ -155,6 +163,7 @@ void JumpSlime(Slime *slime)
 
          // Enter in-flight state.
          slime->in_flight_time = 1;
+         slime->events |= SLIME_EVENT_JUMP;
       }
 
       const int old_vy = slime->vy;
@@ -224,6 +233,7 @@ void HitSlime(Slime *slime, int vx, int vy)
    // Mark slime as stunned.  This doesn't accumulate, so getting hit
    // multiple times simultaneously will get the same amount of stun.
    slime->stun = 15;
+   slime->events |= SLIME_EVENT_HIT;
 
    // If slime was at rest, it will start falling from the platform it's
    // standing on.
@@ -255,6 +265,7 @@ void LandSlime(Slime *slime, int y)
    slime->vx = 0;
    slime->vy = 0;
    slime->in_flight_time = 0;
+   slime->events |= SLIME_EVENT_LAND;
 
    const int fall_height = slime->y - slime->fall_start;
    if( slime->max_fall < fall_height )
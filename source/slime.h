@@ -8,6 +8,13 @@
 // Number of bits used in the fractional part of slime's position and velocity.
 #define SLIME_FRACTION_BITS   8
 
+// Bits for Slime.events.
+#define SLIME_EVENT_JUMP               (1 << 0)
+#define SLIME_EVENT_LAND               (1 << 1)
+#define SLIME_EVENT_HIT                (1 << 2)
+#define SLIME_EVENT_SPRING_COMPRESS    (1 << 3)
+#define SLIME_EVENT_SPRING_RELEASE     (1 << 4)
+
 // Slime state.
 typedef struct
 {
@@ -51,6 +58,12 @@ typedef struct
    // Height of when vy changed to positive.  This is the starting
    // height of a fall.  LandSlime will use this to update max_fall.
    int fall_start;
+
+   // Bitmask of SLIME_EVENT_* bits for things that happened since this
+   // field was last cleared.  Slime functions only set bits here, and it's
+   // up to the caller to consume and clear them.  This is used to trigger
+   // sound effects for the player slime, and ignored for ghost slimes.
+   unsigned int events;
 } Slime;
 
 // Load sprites.
@@ -0,0 +1,129 @@
+#include"trace.h"
+#include<string.h>
+#include"common.h"
+#include"profile.h"
+#include"trace_format.h"
+
+_Static_assert(TRACE_SECTION_COUNT == kProfileSectionCount,
+               "trace_format.h is out of sync with profile.h");
+_Static_assert(sizeof(TraceHeader) == TRACE_HEADER_SIZE,
+               "Unexpected header size");
+_Static_assert(sizeof(TraceRecord) == TRACE_RECORD_SIZE,
+               "Unexpected record size");
+
+// Number of records to buffer before writing to file.  At 68 bytes per
+// record, this is about 4K, which amortizes the cost of file writes to
+// once every two seconds.
+#define TRACE_BUFFER_SIZE  60
+
+// Trace file, or NULL if tracing is inactive.
+static SDFile *g_trace_file = NULL;
+
+// Buffered records.
+static TraceRecord g_buffer[TRACE_BUFFER_SIZE];
+
+// Number of records in g_buffer.
+static int g_buffer_size = 0;
+
+// Number of records written since OpenTrace.
+static uint32_t g_frame = 0;
+
+// Write buffered records to file.
+static void FlushTrace(PlaydateAPI *pd)
+{
+   assert(g_trace_file != NULL);
+   if( g_buffer_size == 0 )
+      return;
+
+   const int size = g_buffer_size * (int)sizeof(TraceRecord);
+   if( pd->file->write(g_trace_file, g_buffer, size) != size )
+   {
+      // Stop tracing on write errors, most likely due to storage being
+      // full.  Records that were already written are still usable.
+      pd->system->logToConsole("trace: %s", pd->file->geterr());
+      pd->file->close(g_trace_file);
+      g_trace_file = NULL;
+   }
+   g_buffer_size = 0;
+}
+
+// Start a new trace file.
+void OpenTrace(PlaydateAPI *pd)
+{
+   if( g_trace_file != NULL )
+      CloseTrace(pd);
+
+   char *path;
+   pd->system->formatString(
+      &path, "trace_%u.bin", pd->system->getSecondsSinceEpoch(NULL));
+   g_trace_file = pd->file->open(path, kFileWrite);
+   if( g_trace_file == NULL )
+   {
+      pd->system->logToConsole("trace: %s: %s", path, pd->file->geterr());
+      pd->system->realloc(path, 0);
+      return;
+   }
+   pd->system->realloc(path, 0);
+
+   TraceHeader header;
+   memset(&header, 0, sizeof(header));
+   memcpy(header.magic, TRACE_MAGIC, sizeof(header.magic));
+   header.version = TRACE_VERSION;
+   header.section_count = TRACE_SECTION_COUNT;
+   header.record_size = sizeof(TraceRecord);
+   for(int i = 0; i < TRACE_SECTION_COUNT; i++)
+   {
+      const char *name = GetProfileSectionName((ProfileSection)i);
+      assert(strlen(name) < TRACE_NAME_SIZE);
+      strncpy(header.section_name[i], name, TRACE_NAME_SIZE - 1);
+   }
+   pd->file->write(g_trace_file, &header, sizeof(header));
+
+   g_buffer_size = 0;
+   g_frame = 0;
+}
+
+// Append a record for the current frame.
+void WriteTrace(PlaydateAPI *pd, const World *world, int song_beat,
+                int steps)
+{
+   if( g_trace_file == NULL )
+      return;
+
+   TraceRecord *r = &g_buffer[g_buffer_size];
+   r->frame = g_frame++;
+   r->frame_time = GetProfileTime();
+   r->song_beat = song_beat;
+   r->platform_limit = world->platform_limit;
+   r->platform_cursor = world->platform_cursor;
+   r->scroll_offset_y = world->scroll_offset_y;
+   r->slime_x = world->slime.x;
+   r->slime_y = world->slime.y;
+   r->slime_vx = world->slime.vx;
+   r->slime_vy = world->slime.vy;
+   r->slime_in_flight_time = world->slime.in_flight_time > 0xffff
+                             ? 0xffff : world->slime.in_flight_time;
+   r->slime_stun = world->slime.stun > 0xff ? 0xff : world->slime.stun;
+   r->steps = steps;
+   r->meteor_count = world->meteor_end - world->meteor_start;
+
+   const uint32_t *t = GetProfileFrame(0);
+   for(int i = 0; i < TRACE_SECTION_COUNT; i++)
+      r->section_time[i] = t[i] > 0xffff ? 0xffff : t[i];
+
+   if( ++g_buffer_size == TRACE_BUFFER_SIZE )
+      FlushTrace(pd);
+}
+
+// Flush and close trace file.
+void CloseTrace(PlaydateAPI *pd)
+{
+   if( g_trace_file == NULL )
+      return;
+   FlushTrace(pd);
+   if( g_trace_file != NULL )
+   {
+      pd->file->close(g_trace_file);
+      g_trace_file = NULL;
+   }
+}
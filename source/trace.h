@@ -0,0 +1,34 @@
+// Library for writing per-frame performance traces to the data folder.
+//
+// Console logs are only visible while the device is connected to a
+// computer, so frame spikes that happen during normal play go unnoticed.
+// When compiled with -DENABLE_TRACE=1 (see "TRACE" variable in Makefile),
+// each game writes a binary trace file with section timings and a bit of
+// world state for every frame.  These can be copied off the device and
+// examined with trace_analyzer.
+//
+// See trace_format.h for file layout.
+
+#ifndef TRACE_H_
+#define TRACE_H_
+
+#include"pd_api.h"
+#include"world.h"
+
+// Start a new trace file.  File name is based on current time, so that
+// each game gets its own trace.  If the file can not be opened, all
+// subsequent WriteTrace calls are ignored.
+void OpenTrace(PlaydateAPI *pd);
+
+// Append a record for the current frame.  Records are buffered in memory,
+// and only written to file when the buffer is full.
+//
+// This uses the profiler for section timings, and must be called after
+// DrawWorld.
+void WriteTrace(PlaydateAPI *pd, const World *world, int song_beat,
+                int steps);
+
+// Flush buffered records and close trace file.
+void CloseTrace(PlaydateAPI *pd);
+
+#endif  // TRACE_H_
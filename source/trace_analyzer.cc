@@ -0,0 +1,247 @@
+// Summarize trace files written by trace.c.
+//
+// ./trace_analyzer {trace.bin}
+//
+// Output includes frame time percentiles, per-section percentiles, the
+// slowest frames along with world state at those frames, and time spent in
+// each song phase.
+
+#include<stdio.h>
+#include<stdint.h>
+#include<string.h>
+
+#include<algorithm>
+#include<string>
+#include<vector>
+
+#include"trace_format.h"
+
+#ifdef _WIN32
+   #include<fcntl.h>
+   #include<io.h>
+#endif
+
+namespace {
+
+static_assert(sizeof(TraceHeader) == TRACE_HEADER_SIZE);
+static_assert(sizeof(TraceRecord) == TRACE_RECORD_SIZE);
+
+// Number of slowest frames to list.
+static constexpr int kWorstFrameCount = 10;
+
+// Number of song phases, matching PlatformStyle in world.h.
+static constexpr int kPhaseCount = 4;
+
+// Trace contents.
+struct Trace
+{
+   std::vector<std::string> section_names;
+   std::vector<TraceRecord> records;
+};
+
+// Load trace from file.  Returns true on success.
+static bool LoadTrace(FILE *infile, Trace *trace)
+{
+   TraceHeader header;
+   if( fread(&header, sizeof(header), 1, infile) != 1 )
+   {
+      fputs("Error reading trace header\n", stderr);
+      return false;
+   }
+   if( memcmp(header.magic, TRACE_MAGIC, sizeof(header.magic)) != 0 )
+   {
+      fputs("Not a trace file\n", stderr);
+      return false;
+   }
+   if( header.version != TRACE_VERSION ||
+       header.section_count != TRACE_SECTION_COUNT ||
+       header.record_size != sizeof(TraceRecord) )
+   {
+      fprintf(stderr,
+              "Unsupported trace: version=%d, sections=%d, record_size=%d\n",
+              header.version, header.section_count, header.record_size);
+      return false;
+   }
+   for(const char *name : header.section_name)
+      trace->section_names.emplace_back(name, strnlen(name, TRACE_NAME_SIZE));
+
+   // Read records until end of file.  A partial record at the end is
+   // silently dropped, since that is what we get if the device ran out of
+   // storage space in the middle of a write.
+   TraceRecord record;
+   while( fread(&record, sizeof(record), 1, infile) == 1 )
+      trace->records.push_back(record);
+   return true;
+}
+
+// Get a percentile value from a sorted list, using nearest rank method.
+static uint32_t Percentile(const std::vector<uint32_t> &sorted, int p)
+{
+   if( sorted.empty() )
+      return 0;
+   const size_t rank = (sorted.size() * p + 99) / 100;
+   return sorted[rank == 0 ? 0 : rank - 1];
+}
+
+// Print percentiles for a list of timings.
+static void PrintTimings(const char *label, std::vector<uint32_t> t)
+{
+   std::sort(t.begin(), t.end());
+   uint64_t total = 0;
+   for(uint32_t i : t)
+      total += i;
+   printf("%-20s avg=%-6d p50=%-6d p90=%-6d p99=%-6d max=%d\n",
+          label,
+          t.empty() ? 0 : static_cast<int>(total / t.size()),
+          static_cast<int>(Percentile(t, 50)),
+          static_cast<int>(Percentile(t, 90)),
+          static_cast<int>(Percentile(t, 99)),
+          t.empty() ? 0 : static_cast<int>(t.back()));
+}
+
+// Print frame and section timings.
+static void PrintPercentiles(const Trace &trace)
+{
+   std::vector<uint32_t> t;
+   for(const TraceRecord &r : trace.records)
+      t.push_back(r.frame_time);
+   PrintTimings("frame", t);
+
+   for(int i = 0; i < TRACE_SECTION_COUNT; i++)
+   {
+      t.clear();
+      for(const TraceRecord &r : trace.records)
+         t.push_back(r.section_time[i]);
+      PrintTimings(trace.section_names[i].c_str(), t);
+   }
+}
+
+// Print slowest frames along with world state.
+static void PrintWorstFrames(const Trace &trace)
+{
+   std::vector<const TraceRecord*> worst;
+   for(const TraceRecord &r : trace.records)
+      worst.push_back(&r);
+   const size_t count = std::min<size_t>(worst.size(), kWorstFrameCount);
+   std::partial_sort(worst.begin(), worst.begin() + count, worst.end(),
+                     [](const TraceRecord *a, const TraceRecord *b)
+                     {
+                        if( a->frame_time != b->frame_time )
+                           return a->frame_time > b->frame_time;
+                        return a->frame < b->frame;
+                     });
+
+   puts("\nWorst frames:");
+   for(size_t i = 0; i < count; i++)
+   {
+      const TraceRecord &r = *worst[i];
+
+      // Find the most expensive section in this frame.
+      int top = 0;
+      for(int j = 1; j < TRACE_SECTION_COUNT; j++)
+      {
+         if( r.section_time[top] < r.section_time[j] )
+            top = j;
+      }
+
+      printf("frame=%d time=%d phase=%d beat=%d steps=%d "
+             "platform_limit=%d platform_cursor=%d scroll=%d meteors=%d "
+             "slime=(%d,%d) v=(%d,%d) flight=%d stun=%d top=%s:%d\n",
+             static_cast<int>(r.frame),
+             static_cast<int>(r.frame_time),
+             r.song_beat >> 16,
+             r.song_beat & 0xffff,
+             r.steps,
+             r.platform_limit,
+             r.platform_cursor,
+             r.scroll_offset_y,
+             r.meteor_count,
+             r.slime_x, r.slime_y,
+             r.slime_vx, r.slime_vy,
+             r.slime_in_flight_time,
+             r.slime_stun,
+             trace.section_names[top].c_str(),
+             r.section_time[top]);
+   }
+}
+
+// Print time spent in each song phase.
+static void PrintPhases(const Trace &trace)
+{
+   puts("\nTime by phase:");
+   for(int phase = 0; phase < kPhaseCount; phase++)
+   {
+      std::vector<uint32_t> t;
+      uint64_t section_total[TRACE_SECTION_COUNT] = {};
+      for(const TraceRecord &r : trace.records)
+      {
+         if( (r.song_beat >> 16) != phase )
+            continue;
+         t.push_back(r.frame_time);
+         for(int i = 0; i < TRACE_SECTION_COUNT; i++)
+            section_total[i] += r.section_time[i];
+      }
+
+      char label[16];
+      snprintf(label, sizeof(label), "phase %d", phase);
+      PrintTimings(label, t);
+      if( t.empty() )
+         continue;
+
+      // List sections by total time, skipping sections that were never
+      // active in this phase.
+      std::vector<int> order;
+      for(int i = 0; i < TRACE_SECTION_COUNT; i++)
+      {
+         if( section_total[i] > 0 )
+            order.push_back(i);
+      }
+      std::stable_sort(order.begin(), order.end(),
+                       [&section_total](int a, int b)
+                       {
+                          return section_total[a] > section_total[b];
+                       });
+      for(int i : order)
+      {
+         printf("   %-17s avg=%d\n",
+                trace.section_names[i].c_str(),
+                static_cast<int>(section_total[i] / t.size()));
+      }
+   }
+}
+
+}  // namespace
+
+int main(int argc, char **argv)
+{
+   if( argc != 2 )
+      return printf("%s {trace.bin}\n", *argv);
+
+   FILE *infile;
+   if( strcmp(argv[1], "-") == 0 )
+   {
+      #ifdef _WIN32
+         setmode(STDIN_FILENO, O_BINARY);
+      #endif
+      infile = stdin;
+   }
+   else
+   {
+      infile = fopen(argv[1], "rb");
+      if( infile == nullptr )
+         return printf("Error opening %s\n", argv[1]);
+   }
+
+   Trace trace;
+   const bool loaded = LoadTrace(infile, &trace);
+   if( infile != stdin )
+      fclose(infile);
+   if( !loaded )
+      return 1;
+
+   printf("%d frames\n", static_cast<int>(trace.records.size()));
+   PrintPercentiles(trace);
+   PrintWorstFrames(trace);
+   PrintPhases(trace);
+   return 0;
+}
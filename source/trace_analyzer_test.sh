@@ -0,0 +1,97 @@
+#!/bin/bash
+
+if [[ $# -ne 1 ]]; then
+   echo "$0 {trace_analyzer.exe}"
+   exit 1
+fi
+TOOL=$1
+
+set -euo pipefail
+TRACE=$(mktemp)
+OUTPUT=$(mktemp)
+
+function die
+{
+   echo "$1"
+   rm -f "$TRACE" "$OUTPUT"
+   exit 1
+}
+
+# Write a trace file with the specified frame times.  Each argument is
+# "phase:frame_time", and all frame time is attributed to the second
+# section.
+function write_trace
+{
+   perl -e '
+      print pack "a4vvvv", "SLTR", 1, 11, 68, 0;
+      foreach $name (qw(generate meteors platforms collision
+                        background_color draw_background draw_platforms
+                        draw_springs draw_slime draw_meteor draw_hud))
+      {
+         print pack "a20", $name;
+      }
+      $frame = 0;
+      foreach $arg (@ARGV)
+      {
+         ($phase, $time) = split /:/, $arg;
+         print pack "VVl<l<l<l<l<l<l<l<vCCvv11",
+            $frame, $time, ($phase << 16) | $frame,
+            100 + $frame, 90 + $frame, -$frame,
+            200, -300 * $frame, 0, -256, 0, 1, 3, 0,
+            0, ($time > 65535 ? 65535 : $time), 0, 0, 0, 0, 0, 0, 0, 0, 0;
+         $frame++;
+      }' -- "$@" > "$TRACE"
+}
+
+# ................................................................
+
+# Check command line arguments.
+"$TOOL" > /dev/null 2>&1 && die "$LINENO: argc=1"
+"$TOOL" - - > /dev/null 2>&1 && die "$LINENO: argc=3"
+
+# Check read errors.
+"$TOOL" /dev/null > /dev/null 2>&1 && die "$LINENO: empty input"
+head -c 300 /dev/zero | "$TOOL" - > /dev/null 2>&1 \
+   && die "$LINENO: bad magic"
+
+write_trace
+perl -e 'binmode STDIN; $d = join "", <STDIN>;
+         substr($d, 4, 2) = pack "v", 99; print $d;' < "$TRACE" \
+   | "$TOOL" - > /dev/null 2>&1 \
+   && die "$LINENO: bad version"
+
+# Empty trace.
+"$TOOL" "$TRACE" > "$OUTPUT" || die "$LINENO: empty trace"
+grep -qF "0 frames" "$OUTPUT" || die "$LINENO: empty trace frame count"
+
+# Trace with one slow frame in phase 2.
+write_trace 0:1000 0:2000 0:3000 1:4000 1:5000 2:90000 2:6000 3:7000
+"$TOOL" "$TRACE" > "$OUTPUT" || die "$LINENO: basic trace"
+
+grep -qF "8 frames" "$OUTPUT" || die "$LINENO: frame count"
+grep -qE "^frame +avg=14750 +p50=4000 +p90=90000 +p99=90000 +max=90000" \
+   "$OUTPUT" || die "$LINENO: frame percentiles"
+grep -qE "^meteors +avg=11691 .*max=65535" "$OUTPUT" \
+   || die "$LINENO: saturated section percentiles"
+
+# First worst frame should be the slow one, with its world context.
+grep -A1 "Worst frames:" "$OUTPUT" \
+   | grep -qF "frame=5 time=90000 phase=2 beat=5 steps=3 platform_limit=105 platform_cursor=95 scroll=-5 meteors=0 slime=(200,-1500) v=(0,-256) flight=0 stun=1 top=meteors:65535" \
+   || die "$LINENO: worst frame"
+[[ $(grep -c "^frame=" "$OUTPUT") -eq 8 ]] || die "$LINENO: worst frame count"
+
+# Per-phase totals.
+grep -qE "^phase 0 +avg=2000 " "$OUTPUT" || die "$LINENO: phase 0"
+grep -qE "^phase 1 +avg=4500 " "$OUTPUT" || die "$LINENO: phase 1"
+grep -qE "^phase 2 +avg=48000 .*max=90000" "$OUTPUT" \
+   || die "$LINENO: phase 2"
+grep -qE "^phase 3 +avg=7000 " "$OUTPUT" || die "$LINENO: phase 3"
+
+# Truncated trailing record is ignored.
+head -c -10 "$TRACE" | "$TOOL" - > "$OUTPUT" || die "$LINENO: truncated"
+grep -qF "7 frames" "$OUTPUT" || die "$LINENO: truncated frame count"
+
+# ................................................................
+# Cleanup.
+rm -f "$TRACE" "$OUTPUT"
+exit 0
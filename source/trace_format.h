@@ -0,0 +1,89 @@
+// Binary trace file format, shared between the game and trace_analyzer.
+//
+// A trace file consists of a single TraceHeader, followed by zero or more
+// TraceRecord entries, one for each frame while game is in progress.  All
+// fields are little-endian, which is the native byte order for both the
+// device and the hosts that we run the analyzer on, so both sides just
+// read and write these structs as is.
+//
+// This header only depends on stdint.h so that it can be included from
+// host tools.
+
+#ifndef TRACE_FORMAT_H_
+#define TRACE_FORMAT_H_
+
+#include<stdint.h>
+
+// Magic bytes at the start of trace files.
+#define TRACE_MAGIC           "SLTR"
+
+// Format version.  Increment this whenever TraceHeader or TraceRecord
+// changes.
+#define TRACE_VERSION         1
+
+// Number of profiled sections.  This must match kProfileSectionCount.
+#define TRACE_SECTION_COUNT   11
+
+// Maximum length of section names, including the terminating NUL.
+#define TRACE_NAME_SIZE       20
+
+// Expected struct sizes.
+#define TRACE_HEADER_SIZE     (12 + TRACE_SECTION_COUNT * TRACE_NAME_SIZE)
+#define TRACE_RECORD_SIZE     (46 + TRACE_SECTION_COUNT * 2)
+
+typedef struct
+{
+   // TRACE_MAGIC, without the terminating NUL.
+   char magic[4];
+
+   // TRACE_VERSION.
+   uint16_t version;
+
+   // TRACE_SECTION_COUNT.
+   uint16_t section_count;
+
+   // sizeof(TraceRecord).
+   uint16_t record_size;
+
+   // Always zero.
+   uint16_t reserved;
+
+   // Name of each section, as returned by GetProfileSectionName.
+   char section_name[TRACE_SECTION_COUNT][TRACE_NAME_SIZE];
+} TraceHeader;
+
+typedef struct
+{
+   // Frame number since start of game, starting at zero.
+   uint32_t frame;
+
+   // Time from start of update callback to end of DrawWorld, in
+   // microseconds.
+   uint32_t frame_time;
+
+   // Value returned by GetSongBeat.  Lower 16 bits is the beat, upper 16
+   // bits is the song phase.
+   int32_t song_beat;
+
+   // World state after updates.
+   int32_t platform_limit;
+   int32_t platform_cursor;
+   int32_t scroll_offset_y;
+
+   // Slime state after updates.
+   int32_t slime_x, slime_y;
+   int32_t slime_vx, slime_vy;
+   uint16_t slime_in_flight_time;
+   uint8_t slime_stun;
+
+   // Number of UpdateWorld calls in this frame, see GetSimulationSteps.
+   uint8_t steps;
+
+   // Number of meteors between meteor_start and meteor_end.
+   uint16_t meteor_count;
+
+   // Time spent in each section, in microseconds, saturated at 0xffff.
+   uint16_t section_time[TRACE_SECTION_COUNT];
+} TraceRecord;
+
+#endif  // TRACE_FORMAT_H_
@@ -0,0 +1,31 @@
+#include"work_count.h"
+#include<string.h>
+
+// Counter names.  These are used in host reports.
+static const char *kCounterNames[kWorkCounterCount] =
+{
+   "generate",
+   "ghost_step",
+   "sort_move",
+   "cursor_step",
+   "meteor_scan",
+   "platform_scan",
+   "spring_scan",
+   "background_scan",
+   "memory_bytes",
+   "blit",
+};
+
+uint32_t g_work_count[kWorkCounterCount];
+
+// Reset all counters to zero.
+void ResetWorkCount(void)
+{
+   memset(g_work_count, 0, sizeof(g_work_count));
+}
+
+// Get name of a counter.
+const char *GetWorkCounterName(WorkCounter counter)
+{
+   return kCounterNames[counter];
+}
@@ -0,0 +1,51 @@
+// Library for counting units of work done by world updates and drawing.
+//
+// Section timers (see profile.h) tell us how long each part of a frame
+// took, but not why.  When compiled with -DENABLE_WORK_COUNT=1 (see
+// "WORK_COUNT" variable in Makefile, always enabled for host builds),
+// COUNT_WORK adds to a set of global counters, such as the number of
+// platforms scanned or bitmaps drawn.  Counts are deterministic, so they
+// can be compared between runs and between host and device.
+//
+// Otherwise, COUNT_WORK expands to nothing, and counting has no runtime
+// cost.  This library doesn't depend on Playdate API.
+
+#ifndef WORK_COUNT_H_
+#define WORK_COUNT_H_
+
+#include<stdint.h>
+
+// Work counters.
+typedef enum
+{
+   kWorkGenerate,       // AppendSimpleChain + AppendPredefinedShape calls
+   kWorkGhostStep,      // Ghost slime steps for platform placement
+   kWorkSortMove,       // Platforms moved by SortPlatformSuffix
+   kWorkCursorStep,     // AdjustPlatformCursor steps
+   kWorkMeteorScan,     // Meteors spawned or animated
+   kWorkPlatformScan,   // Platforms visited by animation and collision
+   kWorkSpringScan,     // Springs visited by collision
+   kWorkBackgroundScan, // Platforms visited by UpdateBackgroundColor
+   kWorkMemoryBytes,    // Bytes filled or copied by world updates
+   kWorkBlit,           // drawBitmap + drawRotatedBitmap calls
+
+   kWorkCounterCount
+} WorkCounter;
+
+#if ENABLE_WORK_COUNT
+   // Add to a counter.
+   #define COUNT_WORK(counter, n)   (g_work_count[counter] += (uint32_t)(n))
+#else
+   #define COUNT_WORK(counter, n)
+#endif
+
+// Counters since last ResetWorkCount call.
+extern uint32_t g_work_count[kWorkCounterCount];
+
+// Reset all counters to zero.
+void ResetWorkCount(void);
+
+// Get name of a counter.
+const char *GetWorkCounterName(WorkCounter counter);
+
+#endif  // WORK_COUNT_H_
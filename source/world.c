@@ -1,6 +1,12 @@
 #include"world.h"
 #include<string.h>
 #include"common.h"
+#include"heap.h"
+#include"hud.h"
+#include"images.h"
+#include"log_ring.h"
+#include"profile.h"
+#include"work_count.h"
 
 // Offsets from collision rectangle corner to image location.
 #define PLATFORM_OFFSET_X     (-32)
@@ -27,11 +33,80 @@
 // Number of pixels from slime coordinate (bottom edge) to its center.
 #define SLIME_CENTER_OFFSET   9
 
-// Image handles.
-static LCDBitmapTable *g_platform;
-static LCDBitmapTable *g_meteor;
+// Number of platform tables.  Platform images are split into one table
+// per group of platform types, indexed by (platform->type / 6), so that
+// tables can be loaded separately.
+#define PLATFORM_GROUP_COUNT  4
+
+// Number of pixels below the visible area where platforms are still
+// counted as visible for UpdateWorldImages.  Slime moves much less than
+// this in a single frame, so platform tables for areas that the slime falls
+// back into are always loaded before they come into view.
+#define RESIDENCY_MARGIN      SCREEN_HEIGHT
+
+// Image handles.  These are NULL until the corresponding image is loaded,
+// see LoadWorld, LoadPendingWorldImages, and UpdateWorldImages.
+static LCDBitmapTable *g_platform[PLATFORM_GROUP_COUNT];
 static LCDBitmapTable *g_spring;
 
+// Number of meteor rotation steps, see Meteor.frame.
+#define METEOR_FRAME_COUNT    18
+
+#if METEOR_ROTATION_CACHE
+   // Meteor image at rotation step 0.  Other rotation steps are rendered
+   // on first use by GetMeteorFrame, and freed by UpdateWorldImages when no
+   // meteors are live or expected.  Meteors only appear after the first song beat, and
+   // not at all if they are disabled in the menu, so this saves the memory
+   // for the full table for most of the time.
+   //
+   // Cache size is bounded by METEOR_FRAME_COUNT.
+   static LCDBitmap *g_meteor_base;
+   static LCDBitmap *g_meteor_frame[METEOR_FRAME_COUNT];
+   #define METEOR_IMAGE_LOADED   (g_meteor_base != NULL)
+
+   #ifndef NDEBUG
+      // Number of bytes used by rendered meteor frames, and the peak value
+      // since startup.
+      static int g_meteor_frame_bytes = 0;
+      static int g_peak_meteor_frame_bytes = 0;
+   #endif
+
+   // Platform style when meteors were last live, see UpdateWorldImages.
+   static PlatformStyle g_meteor_frame_style = kPlatformTrees;
+#else
+   static LCDBitmapTable *g_meteor;
+   #define METEOR_IMAGE_LOADED   (g_meteor != NULL)
+#endif
+
+// Image paths for each platform table, indexed by (platform->type / 6).
+static const char *kPlatformPath[PLATFORM_GROUP_COUNT] =
+{
+   "platform0",   // Space.
+   "platform1",   // Clouds.
+   "platform2",   // Rocks.
+   "platform3",   // Trees.
+};
+
+#ifndef NDEBUG
+// Number of bytes used by each platform table, or zero if the table has
+// never been loaded.
+static int g_platform_bytes[PLATFORM_GROUP_COUNT];
+
+// Number of bytes used by platform tables that are currently loaded, and
+// the peak value since the last ReportWorldImages call.
+static int g_resident_bytes = 0;
+static int g_peak_resident_bytes = 0;
+
+// Maximum values of platform_limit, spring_limit, and meteor_end since the
+// last ReportWorldMemory call.
+static int g_max_platform_limit = 0;
+static int g_max_spring_limit = 0;
+static int g_max_meteor_end = 0;
+#endif
+
+// Cached rendering of current height.
+static HudNumber g_height_text;
+
 // Background patterns.
 #include"build/gray_patterns.txt"
 
@@ -53,16 +128,226 @@ static const int kPlatformHeight[4] =
 // Syntactic sugar.
 static int Min(int a, int b) { return a < b ? a : b; }
 
-// Load world tiles.
+// Get platform table index for the platforms generated in a phase.
+static int GetPlatformGroup(PlatformStyle style)
+{
+   return 3 - (int)style;
+}
+
+// Load a platform table.
+static void LoadPlatformGroup(int group, PlaydateAPI *pd)
+{
+   assert(g_platform[group] == NULL);
+   g_platform[group] = LoadImageTable(pd, kPlatformPath[group]);
+
+   #ifndef NDEBUG
+      g_platform_bytes[group] = GetTableBytes(g_platform[group], pd);
+      g_resident_bytes += g_platform_bytes[group];
+      if( g_peak_resident_bytes < g_resident_bytes )
+         g_peak_resident_bytes = g_resident_bytes;
+      LOG_EVENT("images: loaded platform%d, resident platform bytes = %d",
+                group, g_resident_bytes);
+   #endif
+}
+
+// Unload a platform table.
+static void FreePlatformGroup(int group, PlaydateAPI *pd)
+{
+   assert(g_platform[group] != NULL);
+   pd->graphics->freeBitmapTable(g_platform[group]);
+   g_platform[group] = NULL;
+
+   #ifndef NDEBUG
+      g_resident_bytes -= g_platform_bytes[group];
+      LOG_EVENT("images: freed platform%d, resident platform bytes = %d",
+                group, g_resident_bytes);
+   #endif
+}
+
+// Load tiles needed for the title screen.
 void LoadWorld(PlaydateAPI *pd)
 {
-   const char *error;
-   g_platform = pd->graphics->loadBitmapTable("platform", &error);
-   assert(g_platform != NULL);
-   g_meteor = pd->graphics->loadBitmapTable("meteor", &error);
-   assert(g_meteor != NULL);
-   g_spring = pd->graphics->loadBitmapTable("spring", &error);
-   assert(g_spring != NULL);
+   LoadPlatformGroup(GetPlatformGroup(kPlatformTrees), pd);
+   InitHudNumber(&g_height_text, NULL, pd);
+}
+
+// Load one of the remaining world tiles.
+int LoadPendingWorldImages(PlaydateAPI *pd)
+{
+   // Springs may appear within the first few screens, and meteors shortly
+   // after game start, so those are loaded first.  Platform tables are
+   // managed separately by UpdateWorldImages.
+   if( g_spring == NULL )
+   {
+      g_spring = LoadImageTable(pd, "spring");
+      return 0;
+   }
+   if( !METEOR_IMAGE_LOADED )
+   {
+      #if METEOR_ROTATION_CACHE
+         g_meteor_base = LoadImage(pd, "meteor");
+         #ifndef NDEBUG
+            LOG_EVENT("images: meteor base image = %d bytes",
+                      GetBitmapBytes(g_meteor_base, pd));
+         #endif
+      #else
+         g_meteor = LoadImageTable(pd, "meteor");
+         #ifndef NDEBUG
+            LOG_EVENT("images: meteor table = %d bytes",
+                      GetTableBytes(g_meteor, pd));
+         #endif
+      #endif
+      return 0;
+   }
+   return 1;
+}
+
+// Mark platform tables needed for platforms generated in a phase.
+static void MarkPlatformGroups(PlatformStyle style, int *needed)
+{
+   needed[GetPlatformGroup(style)] = 1;
+
+   // Rock phase also generates cloud platforms as diversions, see
+   // AppendSimpleChain.
+   if( style == kPlatformRocks )
+      needed[GetPlatformGroup(kPlatformClouds)] = 1;
+}
+
+#if METEOR_ROTATION_CACHE
+// Free all rendered meteor frames.
+static void FreeMeteorFrames(PlaydateAPI *pd)
+{
+   #ifndef NDEBUG
+      int count = 0;
+      int bytes = 0;
+   #endif
+   for(int i = 0; i < METEOR_FRAME_COUNT; i++)
+   {
+      if( g_meteor_frame[i] == NULL )
+         continue;
+      #ifndef NDEBUG
+         count++;
+         bytes += GetBitmapBytes(g_meteor_frame[i], pd);
+      #endif
+      pd->graphics->freeBitmap(g_meteor_frame[i]);
+      g_meteor_frame[i] = NULL;
+   }
+   #ifndef NDEBUG
+      if( count > 0 )
+      {
+         LOG_EVENT("images: freed %d meteor frames, %d bytes", count, bytes);
+         g_meteor_frame_bytes -= bytes;
+      }
+   #endif
+}
+#endif
+
+// Load and unload platform tables, and free unused meteor frames.
+void UpdateWorldImages(const World *world,
+                       PlatformStyle upcoming_style,
+                       PlaydateAPI *pd)
+{
+   // Tables are needed for the current and upcoming phase, and for any
+   // platform that is within view or just below it.  Platforms above the
+   // visible area were all generated in the current phase.
+   int needed[PLATFORM_GROUP_COUNT] = {0};
+   MarkPlatformGroups(world->platform_style, needed);
+   MarkPlatformGroups(upcoming_style, needed);
+
+   const Platform *platform = world->platform;
+   const int end_index =
+      Min(world->platform_cursor + 30, world->platform_limit);
+   for(int i = end_index; i-- > 0;)
+   {
+      if( platform[i].type < 0 )
+         break;
+      if( platform[i].y + PLATFORM_OFFSET_Y + world->scroll_offset_y >=
+          SCREEN_HEIGHT + RESIDENCY_MARGIN )
+         break;
+      needed[platform[i].type / 6] = 1;
+   }
+
+   // Free tables that are no longer needed, and load at most one table per
+   // call to limit the cost of a single frame.
+   int loaded = 0;
+   for(int i = 0; i < PLATFORM_GROUP_COUNT; i++)
+   {
+      if( needed[i] )
+      {
+         if( g_platform[i] == NULL && !loaded )
+         {
+            LoadPlatformGroup(i, pd);
+            loaded = 1;
+         }
+      }
+      else if( g_platform[i] != NULL )
+      {
+         FreePlatformGroup(i, pd);
+      }
+   }
+
+   #if METEOR_ROTATION_CACHE
+      // Rendered meteor frames are kept across short gaps between meteors,
+      // since rendering them again mid-game costs a bitmap allocation and
+      // a rotation per frame.  They are freed only when no meteors are live
+      // and none are expected soon: meteors are disabled, the phase has
+      // changed since meteors were last live, or the world has been reset
+      // (meteors only appear after the first beat).
+      if( world->meteor_start != world->meteor_end )
+      {
+         g_meteor_frame_style = world->platform_style;
+      }
+      else if( world->disable_meteors ||
+               world->beat == 0 ||
+               world->platform_style != g_meteor_frame_style )
+      {
+         FreeMeteorFrames(pd);
+      }
+   #endif
+}
+
+// Log peak memory used by platform tables.
+void ReportWorldImages(void)
+{
+   #ifndef NDEBUG
+      // Total size of all tables is what the peak was before tables were
+      // loaded on demand.
+      int all_bytes = 0;
+      int known_groups = 0;
+      for(int i = 0; i < PLATFORM_GROUP_COUNT; i++)
+      {
+         if( g_platform_bytes[i] > 0 )
+         {
+            all_bytes += g_platform_bytes[i];
+            known_groups++;
+         }
+      }
+      LOG_EVENT("images: peak resident platform bytes = %d, "
+                "all %d known platform tables = %d bytes",
+                g_peak_resident_bytes, known_groups, all_bytes);
+      g_peak_resident_bytes = g_resident_bytes;
+   #endif
+}
+
+// Log size of World and how much of each array was used.
+void ReportWorldMemory(void)
+{
+   #ifndef NDEBUG
+      LOG_EVENT("memory: World = %d bytes, platform = %d bytes, "
+                "meteor = %d bytes, spring = %d bytes",
+                (int)sizeof(World),
+                (int)sizeof(((World*)NULL)->platform),
+                (int)sizeof(((World*)NULL)->meteor),
+                (int)sizeof(((World*)NULL)->spring));
+      LOG_EVENT("memory: max platform_limit = %d/%d, spring_limit = %d/%d, "
+                "meteor_end = %d/%d",
+                g_max_platform_limit, MAX_PLATFORMS,
+                g_max_spring_limit, MAX_SPRINGS,
+                g_max_meteor_end, MAX_METEORS);
+      g_max_platform_limit = 0;
+      g_max_spring_limit = 0;
+      g_max_meteor_end = 0;
+   #endif
 }
 
 // Reset world to initial state.
@@ -75,6 +360,8 @@ void ResetWorld(World *world)
    world->platform[0].x = 0;
    world->platform[0].y = 0;
    world->platform[0].type = -1;
+   world->platform[0].vx = 0;
+   world->platform[0].spring_index = -1;
 
    world->beat = 0;
    world->meteor_start = 0;
@@ -89,6 +376,8 @@ void ResetWorld(World *world)
 // Draw background pattern.
 static void DrawBackground(const World *world, PlaydateAPI *pd)
 {
+   PROFILE_SCOPE(kProfileDrawBackground);
+
    // Initialize background pattern, taking scrolling into account.
    LCDPattern pattern;
    memcpy(pattern,
@@ -105,7 +394,7 @@ static void DrawBackground(const World *world, PlaydateAPI *pd)
 // platform is outside of visible area.
 static void DrawPlatforms(const World *world, PlaydateAPI *pd)
 {
-   assert(g_platform != NULL);
+   PROFILE_SCOPE(kProfileDrawPlatforms);
 
    // Draw platforms from back to front.  This is because new platforms that
    // are at higher elevations are appended to the end of the array, and should
@@ -131,18 +420,28 @@ static void DrawPlatforms(const World *world, PlaydateAPI *pd)
 
       assert(platform[i].type >= 0);
       assert(platform[i].type < 24);
-      LCDBitmap *tile = pd->graphics->getTableBitmap(g_platform,
-                                                     platform[i].type);
-      assert(tile != NULL);
       const int x = platform[i].x + PLATFORM_OFFSET_X;
       const int y = platform[i].y + PLATFORM_OFFSET_Y + world->scroll_offset_y;
-      pd->graphics->drawBitmap(tile, x, y, kBitmapUnflipped);
 
-      // Wraparound.
-      pd->graphics->drawBitmap(tile,
-                               x < 0 ? x + SCREEN_WIDTH : x - SCREEN_WIDTH,
-                               y,
-                               kBitmapUnflipped);
+      // Skip platforms with tables that are not loaded yet.  This doesn't
+      // happen in practice since UpdateWorldImages loads tables ahead of
+      // the phase change and before the platforms come into view, but we
+      // still don't want to crash if it did happen.
+      LCDBitmapTable *table = g_platform[platform[i].type / 6];
+      if( table != NULL )
+      {
+         LCDBitmap *tile =
+            pd->graphics->getTableBitmap(table, platform[i].type % 6);
+         assert(tile != NULL);
+         COUNT_WORK(kWorkBlit, 2);
+         pd->graphics->drawBitmap(tile, x, y, kBitmapUnflipped);
+
+         // Wraparound.
+         pd->graphics->drawBitmap(tile,
+                                  x < 0 ? x + SCREEN_WIDTH : x - SCREEN_WIDTH,
+                                  y,
+                                  kBitmapUnflipped);
+      }
 
       if( y >= SCREEN_HEIGHT )
          break;
@@ -152,6 +451,9 @@ static void DrawPlatforms(const World *world, PlaydateAPI *pd)
 // Draw mechanical springs.
 static void DrawSprings(const World *world, PlaydateAPI *pd)
 {
+   PROFILE_SCOPE(kProfileDrawSprings);
+   if( g_spring == NULL )
+      return;
    for(int i = world->spring_limit; i-- > 0;)
    {
       const int y =
@@ -164,30 +466,82 @@ static void DrawSprings(const World *world, PlaydateAPI *pd)
                                                   world->spring[i].frame);
       assert(s != NULL);
       const int x = world->spring[i].x + SPRING_OFFSET_X;
+      COUNT_WORK(kWorkBlit, 1);
       pd->graphics->drawBitmap(s, x, y, kBitmapUnflipped);
 
       // Wraparound.
       if( x >= SCREEN_WIDTH - 32 )
       {
+         COUNT_WORK(kWorkBlit, 1);
          pd->graphics->drawBitmap(s, x - SCREEN_WIDTH, y, kBitmapUnflipped);
       }
       else if( world->spring[i].x < 32 )
       {
+         COUNT_WORK(kWorkBlit, 1);
          pd->graphics->drawBitmap(s, x + SCREEN_WIDTH, y, kBitmapUnflipped);
       }
    }
 }
 
+#if METEOR_ROTATION_CACHE
+
+// Get meteor image for a rotation step, rendering it if needed.
+static LCDBitmap *GetMeteorFrame(int frame, PlaydateAPI *pd)
+{
+   assert(frame >= 0);
+   assert(frame < METEOR_FRAME_COUNT);
+   if( g_meteor_frame[frame] != NULL )
+      return g_meteor_frame[frame];
+
+   // Rotate around the center of the base image, with output bitmap being
+   // the same size as the prerotated frames.  Meteor image is round with
+   // some margin, so nothing gets clipped.
+   LCDBitmap *bitmap = pd->graphics->newBitmap(64, 64, kColorClear);
+   assert(bitmap != NULL);
+   #ifndef NDEBUG
+      // Record peak cache size, so that ReportImageMemory shows the peak
+      // as bytes and the number of rendered frames as loads.
+      const int bytes = GetBitmapBytes(bitmap, pd);
+      CountApiAllocation(bytes);
+      g_meteor_frame_bytes += bytes;
+      if( g_peak_meteor_frame_bytes < g_meteor_frame_bytes )
+         g_peak_meteor_frame_bytes = g_meteor_frame_bytes;
+      RecordImageMemory("meteor frames", g_peak_meteor_frame_bytes);
+   #endif
+   pd->graphics->pushContext(bitmap);
+   COUNT_WORK(kWorkBlit, 1);
+   pd->graphics->drawRotatedBitmap(
+      g_meteor_base, 32, 32, (float)frame * (360.0f / METEOR_FRAME_COUNT),
+      0.5f, 0.5f, 1.0f, 1.0f);
+   pd->graphics->popContext();
+   g_meteor_frame[frame] = bitmap;
+   return bitmap;
+}
+
+#else
+
+// Get meteor image for a rotation step.
+static LCDBitmap *GetMeteorFrame(int frame, PlaydateAPI *pd)
+{
+   return pd->graphics->getTableBitmap(g_meteor, frame);
+}
+
+#endif
+
 // Draw meteors.
 static void DrawMeteor(const World *world, PlaydateAPI *pd)
 {
+   PROFILE_SCOPE(kProfileDrawMeteor);
+   if( !METEOR_IMAGE_LOADED )
+      return;
    for(int i = world->meteor_start; i < world->meteor_end; i++)
    {
       const Meteor *meteor = &(world->meteor[i]);
-      LCDBitmap *sprite = pd->graphics->getTableBitmap(g_meteor, meteor->frame);
+      LCDBitmap *sprite = GetMeteorFrame(meteor->frame, pd);
       assert(sprite != NULL);
       const int x = meteor->x + METEOR_OFFSET_X;
       const int y = meteor->y + METEOR_OFFSET_Y + world->scroll_offset_y;
+      COUNT_WORK(kWorkBlit, 1);
       pd->graphics->drawBitmap(sprite, x, y, kBitmapUnflipped);
    }
 }
@@ -201,7 +555,7 @@ static int GetWorldCeiling(const World *world)
 }
 
 // Get platform width from platform type.
-static int GetPlatformWidth(int type)
+int GetPlatformWidth(int type)
 {
    if( type < 0 )
       return SCREEN_WIDTH;
@@ -229,8 +583,17 @@ static uint16_t GetPlatformVelocity(int base_type)
    return vx < 0 ? SCREEN_WIDTH + vx : vx;
 }
 
+// Platform order checks.  Checking the entire platform list after every
+// append makes platform generation quadratic in debug builds, so normally
+// we only check the platforms that were appended or moved.  Compile with
+// -DFULL_SORT_CHECK_INTERVAL=N (see "SORT_CHECK" in Makefile) to also check
+// the entire list on every N-th check.
+#ifndef FULL_SORT_CHECK_INTERVAL
+   #define FULL_SORT_CHECK_INTERVAL 0
+#endif
+
+#if !defined(NDEBUG) && FULL_SORT_CHECK_INTERVAL > 0
 // Check that the entire platform list is sorted.
-#ifndef NDEBUG
 static int IsSorted(const World *world)
 {
    for(int i = 1; i < world->platform_limit; i++)
@@ -242,6 +605,29 @@ static int IsSorted(const World *world)
 }
 #endif
 
+#ifndef NDEBUG
+// Check that the last few platforms are sorted, including the boundary
+// between those platforms and the rest of the list.
+static int IsSortedSuffix(const World *world, int count)
+{
+   assert(count > 0);
+   assert(count <= world->platform_limit);
+   const int start = world->platform_limit - count;
+   for(int i = start > 0 ? start : 1; i < world->platform_limit; i++)
+   {
+      if( world->platform[i - 1].y < world->platform[i].y )
+         return 0;
+   }
+
+   #if FULL_SORT_CHECK_INTERVAL > 0
+      static unsigned int check_count = 0;
+      if( ++check_count % FULL_SORT_CHECK_INTERVAL == 0 )
+         return IsSorted(world);
+   #endif
+   return 1;
+}
+#endif
+
 // Move the newly appended platform into the right place.  We don't need to
 // do a full sort since we know only the last appended platform is out of
 // order, so we just have to move that one into the right place.
@@ -257,13 +643,19 @@ static void SortPlatformSuffix(World *world)
    const int suffix_length = world->platform_limit - i;
    assert(suffix_length > 0);
    if( suffix_length == 1 )
+   {
+      assert(IsSortedSuffix(world, 1));
       return;
+   }
+   COUNT_WORK(kWorkSortMove, suffix_length);
+   COUNT_WORK(kWorkMemoryBytes, sizeof(Platform) * (suffix_length + 1));
 
    const Platform tmp = world->platform[world->platform_limit - 1];
    memmove(world->platform + i,
            world->platform + i - 1,
            sizeof(Platform) * suffix_length);
    memcpy(world->platform + i, &tmp, sizeof(Platform));
+   assert(IsSortedSuffix(world, suffix_length));
 }
 
 // Generate platforms that are simple chains.  In this method, there will be
@@ -305,6 +697,7 @@ static void AppendSimpleChain(World *world, int base_type, int diversion_rate)
       // Jump is applied repeatedly to ensure full velocity.
       JumpSlime(&ghost);
       UpdateSlime(&ghost);
+      COUNT_WORK(kWorkGhostStep, 1);
    }
 
    // Where this ghost lands will be the center of where we place the
@@ -321,7 +714,7 @@ static void AppendSimpleChain(World *world, int base_type, int diversion_rate)
    assert(new_platform->y < GetWorldCeiling(world));
    world->platform_limit++;
    assert(world->platform_limit <= MAX_PLATFORMS);
-   assert(IsSorted(world));
+   assert(IsSortedSuffix(world, 1));
 
    // Insert a random platform off to the side once in a while, so that
    // we don't have too much empty space in places that stray from the
@@ -377,7 +770,6 @@ static void AppendSimpleChain(World *world, int base_type, int diversion_rate)
       }
 
       SortPlatformSuffix(world);
-      assert(IsSorted(world));
    }
 }
 
@@ -403,6 +795,7 @@ static void AppendPredefinedShape(World *world, int base_type)
    {
       JumpSlime(&ghost);
       UpdateSlime(&ghost);
+      COUNT_WORK(kWorkGhostStep, 1);
    }
 
    // All platforms in the set get the same velocity, so that their relative
@@ -420,7 +813,7 @@ static void AppendPredefinedShape(World *world, int base_type)
    const int vertical_distance =
       world->platform[world->platform_limit - 1].y - new_platform->y;
    world->platform_limit++;
-   assert(IsSorted(world));
+   assert(IsSortedSuffix(world, 1));
 
    // From this new platform, we will append an S-shaped route.
    const int p0y = new_platform->y;
@@ -480,7 +873,7 @@ static void AppendPredefinedShape(World *world, int base_type)
    new_platform->vx = vx;
    new_platform->spring_index = -1;
 
-   assert(IsSorted(world));
+   assert(IsSortedSuffix(world, 3));
 }
 
 // Adjust platform_cursor position to be at or below slime Y position.
@@ -495,6 +888,7 @@ static void AdjustPlatformCursor(World *world, int slime_y)
    while( world->platform[world->platform_cursor].y >= slime_y )
    {
       world->platform_cursor++;
+      COUNT_WORK(kWorkCursorStep, 1);
 
       // Slime can never reach the highest platform, because we always generate
       // new platforms at higher elevations just outside of the view.
@@ -505,6 +899,7 @@ static void AdjustPlatformCursor(World *world, int slime_y)
    while( world->platform[world->platform_cursor].y < slime_y )
    {
       world->platform_cursor--;
+      COUNT_WORK(kWorkCursorStep, 1);
       if( world->platform_cursor == 0 )
          return;
    }
@@ -516,6 +911,8 @@ static void AdjustPlatformCursor(World *world, int slime_y)
 // Spawn meteors toward player.
 static void SpawnMeteors(World *world)
 {
+   PROFILE_SCOPE(kProfileMeteors);
+
    const int target_x = world->slime.x >> SLIME_FRACTION_BITS;
    const int target_y = (world->slime.y >> SLIME_FRACTION_BITS) -
                         SLIME_CENTER_OFFSET;
@@ -523,8 +920,9 @@ static void SpawnMeteors(World *world)
    for(; world->meteor_end < world->beat; world->meteor_end++)
    {
       assert(world->meteor_end < MAX_METEORS);
+      COUNT_WORK(kWorkMeteorScan, 1);
       Meteor *new_meteor = &world->meteor[world->meteor_end];
-      new_meteor->frame = RAND_RANGE(0, 17);
+      new_meteor->frame = RAND_RANGE(0, METEOR_FRAME_COUNT - 1);
       new_meteor->hit = 0;
 
       // Set velocity.
@@ -565,11 +963,14 @@ static void SpawnMeteors(World *world)
 // Animate meteors and garbage collect dead meteors.
 static void AnimateMeteors(World *world)
 {
+   PROFILE_SCOPE(kProfileMeteors);
+
    // Center of slime.
    const int target_x = world->slime.x >> SLIME_FRACTION_BITS;
    const int target_y = (world->slime.y >> SLIME_FRACTION_BITS) -
                         SLIME_CENTER_OFFSET;
 
+   COUNT_WORK(kWorkMeteorScan, world->meteor_end - world->meteor_start);
    for(int i = world->meteor_start; i < world->meteor_end; i++)
    {
       Meteor *meteor = &(world->meteor[i]);
@@ -621,7 +1022,7 @@ static void AnimateMeteors(World *world)
          }
          else
          {
-            meteor->frame = (meteor->frame + 1) % 18;
+            meteor->frame = (meteor->frame + 1) % METEOR_FRAME_COUNT;
          }
       }
       else
@@ -633,7 +1034,8 @@ static void AnimateMeteors(World *world)
          }
          else
          {
-            meteor->frame = (meteor->frame + 17) % 18;
+            meteor->frame = (meteor->frame + METEOR_FRAME_COUNT - 1) %
+                            METEOR_FRAME_COUNT;
          }
       }
    }
@@ -642,15 +1044,18 @@ static void AnimateMeteors(World *world)
 // Set background color.
 static void UpdateBackgroundColor(World *world)
 {
+   PROFILE_SCOPE(kProfileBackgroundColor);
    const Platform *platform = world->platform;
 
    // Find all color indices at each scanline.
    uint8_t background_color[SCREEN_HEIGHT];
    memset(background_color, kGrayLevel[3], SCREEN_HEIGHT);
+   COUNT_WORK(kWorkMemoryBytes, SCREEN_HEIGHT);
    const int end_index =
       Min(world->platform_cursor + 30, world->platform_limit);
    for(int i = end_index; i-- > 1;)
    {
+      COUNT_WORK(kWorkBackgroundScan, 1);
       assert(platform[i].type >= 0);
       assert(platform[i].type < 24);
       assert(platform[i].y <= platform[i - 1].y);
@@ -675,6 +1080,7 @@ static void UpdateBackgroundColor(World *world)
       memset(background_color + start_y,
              kGrayLevel[platform[i].type / 6],
              height);
+      COUNT_WORK(kWorkMemoryBytes, height);
    }
 
    unsigned int average_color = 0;
@@ -686,19 +1092,21 @@ static void UpdateBackgroundColor(World *world)
    world->background_color = average_color;
 }
 
-// Run a single time step of world+slime updates.
-void UpdateWorld(World *world)
+// Add new platforms until all visible area is covered.
+//
+// We need to generate platforms ahead of the player so that they will have
+// somewhere to go, but we also want to generate them as late as possible
+// since the type of platform generated depends on current song position,
+// and we don't want the visuals to deviate from the song too much.
+static void GeneratePlatforms(World *world)
 {
-   // Add new platforms until all visible area is covered.
-   //
-   // We need to generate platforms ahead of the player so that they will have
-   // somewhere to go, but we also want to generate them as late as possible
-   // since the type of platform generated depends on current song position,
-   // and we don't want the visuals to deviate from the song too much.
+   PROFILE_SCOPE(kProfileGenerate);
+
    while( GetWorldCeiling(world) +
           kPlatformHeight[world->platform_style] +
           world->scroll_offset_y >= 0 )
    {
+      COUNT_WORK(kWorkGenerate, 1);
       switch( world->platform_style )
       {
          case kPlatformTrees:
@@ -721,14 +1129,16 @@ void UpdateWorld(World *world)
             break;
       }
    }
+}
 
-   // Update meteors.
-   SpawnMeteors(world);
-   AnimateMeteors(world);
+// Animate platforms.  All platforms are animated whether they are visible
+// or not.  This is so that the relative position of the platforms remain
+// constant for platforms with the same velocity.
+static void AnimatePlatforms(World *world)
+{
+   PROFILE_SCOPE(kProfilePlatforms);
 
-   // Animate platforms.  All platforms are animated whether they are visible
-   // or not.  This is so that the relative position of the platforms remain
-   // constant for platforms with the same velocity.
+   COUNT_WORK(kWorkPlatformScan, world->platform_limit);
    for(int i = 0; i < world->platform_limit; i++)
    {
       Platform *p = &(world->platform[i]);
@@ -741,8 +1151,13 @@ void UpdateWorld(World *world)
             (world->spring[p->spring_index].x + p->vx) % SCREEN_WIDTH;
       }
    }
+}
+
+// Apply slime movement and resolve collisions with springs and platforms.
+static void MoveSlime(World *world)
+{
+   PROFILE_SCOPE(kProfileCollision);
 
-   // Apply slime movement.
    const int old_y = world->slime.y >> SLIME_FRACTION_BITS;
    AdjustPlatformCursor(world, old_y);
    const int old_platform_cursor = world->platform_cursor;
@@ -758,6 +1173,7 @@ void UpdateWorld(World *world)
       // Check for collision with springs before checking for collision
       // with platforms.
       const int slime_x = world->slime.x >> SLIME_FRACTION_BITS;
+      COUNT_WORK(kWorkSpringScan, world->spring_limit);
       for(int i = world->spring_limit; i-- > 0;)
       {
          // Ignore springs that are out of range, and also reset their
@@ -788,6 +1204,8 @@ void UpdateWorld(World *world)
                world->slime.vy = 1 << SLIME_FRACTION_BITS;
             else
                world->slime.vy = 1 << (SLIME_FRACTION_BITS - 3);
+            if( world->spring[i].frame == 0 )
+               world->slime.events |= SLIME_EVENT_SPRING_COMPRESS;
             world->spring[i].frame++;
          }
          else
@@ -796,6 +1214,7 @@ void UpdateWorld(World *world)
             // vertical velocity.
             world->slime.vy = SPRING_VELOCITY;
             world->spring[i].frame = 0;
+            world->slime.events |= SLIME_EVENT_SPRING_RELEASE;
          }
       }
 
@@ -812,6 +1231,7 @@ void UpdateWorld(World *world)
          // Stop checking if platform is below slime position.
          if( world->platform[i].y > new_y )
             break;
+         COUNT_WORK(kWorkPlatformScan, 1);
 
          const int x0 = world->platform[i].x;
          const int x1 =
@@ -837,6 +1257,21 @@ void UpdateWorld(World *world)
                           (SCREEN_WIDTH << SLIME_FRACTION_BITS);
       }
    }
+}
+
+// Run a single time step of world+slime updates.
+void UpdateWorld(World *world)
+{
+   GeneratePlatforms(world);
+
+   // Update meteors.
+   SpawnMeteors(world);
+   AnimateMeteors(world);
+
+   AnimatePlatforms(world);
+
+   // Apply slime movement.
+   MoveSlime(world);
 
    // Adjust camera to follow slime.
    // 1. target_offset is set to 3/4 of screen height.  The intent is to keep
@@ -865,6 +1300,63 @@ void UpdateWorld(World *world)
 
    // Set background color.
    UpdateBackgroundColor(world);
+
+   #ifndef NDEBUG
+      if( g_max_platform_limit < world->platform_limit )
+         g_max_platform_limit = world->platform_limit;
+      if( g_max_spring_limit < world->spring_limit )
+         g_max_spring_limit = world->spring_limit;
+      if( g_max_meteor_end < world->meteor_end )
+         g_max_meteor_end = world->meteor_end;
+   #endif
+}
+
+// Check if world would remain static in the next update.
+int IsWorldAtRest(const World *world)
+{
+   // Slime must be at rest, and its animation must have settled.
+   const Slime *slime = &(world->slime);
+   if( slime->in_flight_time != 0 || slime->frame != 0 || slime->stun != 0 )
+      return 0;
+
+   // There must not be any live meteors or meteors waiting to be spawned.
+   if( world->meteor_start != world->meteor_end ||
+       world->meteor_end < world->beat )
+   {
+      return 0;
+   }
+
+   // There must not be any pending platforms to be generated.
+   if( GetWorldCeiling(world) +
+       kPlatformHeight[world->platform_style] +
+       world->scroll_offset_y >= 0 )
+   {
+      return 0;
+   }
+
+   // Camera must have converged to target offset.
+   const int target_offset =
+      (3 * SCREEN_HEIGHT / 4 - (world->slime.y >> SLIME_FRACTION_BITS));
+   if( world->scroll_offset_y !=
+       (((7 * world->scroll_offset_y + target_offset) / 8) & ~1) )
+   {
+      return 0;
+   }
+
+   // There must not be any moving platforms in view.  This checks the same
+   // range of platforms as DrawPlatforms.  Platforms that are out of view
+   // may still be moving, but those would not cause visible changes.
+   const int end_index =
+      Min(world->platform_cursor + 30, world->platform_limit);
+   for(int i = end_index; i-- > 1;)
+   {
+      const Platform *p = &(world->platform[i]);
+      if( p->y + PLATFORM_OFFSET_Y + world->scroll_offset_y >= SCREEN_HEIGHT )
+         break;
+      if( p->vx != 0 )
+         return 0;
+   }
+   return 1;
 }
 
 // Draw updated world.
@@ -878,24 +1370,10 @@ void DrawWorld(const World *world, PlaydateAPI *pd)
 
    if( world->slime.y < 0 )
    {
-      char *text = NULL;
-      const int length = pd->system->formatString(
-         &text, "%d", (-world->slime.y) >> SLIME_FRACTION_BITS);
-      if( world->background_color < 32 )
-      {
-         pd->graphics->setDrawMode(kDrawModeFillBlack);
-         pd->graphics->drawText(text, length, kASCIIEncoding, 7, 222);
-         pd->graphics->setDrawMode(kDrawModeFillWhite);
-         pd->graphics->drawText(text, length, kASCIIEncoding, 5, 220);
-      }
-      else
-      {
-         pd->graphics->setDrawMode(kDrawModeFillWhite);
-         pd->graphics->drawText(text, length, kASCIIEncoding, 7, 222);
-         pd->graphics->setDrawMode(kDrawModeFillBlack);
-         pd->graphics->drawText(text, length, kASCIIEncoding, 5, 220);
-      }
-      pd->graphics->setDrawMode(kDrawModeCopy);
-      pd->system->realloc(text, 0);
+      DrawHudNumber(&g_height_text,
+                    (-world->slime.y) >> SLIME_FRACTION_BITS,
+                    world->background_color < 32 ? kHudWhiteOnBlack
+                                                 : kHudBlackOnWhite,
+                    5, 220, pd);
    }
 }
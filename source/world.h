@@ -166,15 +166,48 @@ typedef struct
    Platform platform[MAX_PLATFORMS];
 } World;
 
-// Load world tiles.
+// Load world tiles needed for the title screen.  LoadHud must have been
+// called first.
 void LoadWorld(PlaydateAPI *pd);
 
+// Load one of the remaining world tiles.  This is meant to be called once
+// per frame after LoadWorld, so that the cost of loading is spread across
+// multiple frames.  Returns 1 if all tiles have been loaded, 0 otherwise.
+//
+// Tiles that are not yet loaded are not drawn.
+int LoadPendingWorldImages(PlaydateAPI *pd);
+
+// Load platform tables needed for the current phase, the upcoming phase,
+// and platforms that are near the visible area, and free the tables that
+// are not needed.  In builds with METEOR_ROTATION_CACHE, this also frees
+// rendered meteor frames once meteors are no longer expected.  This is
+// meant to be called once per frame.
+void UpdateWorldImages(const World *world,
+                       PlatformStyle upcoming_style,
+                       PlaydateAPI *pd);
+
+// Log peak memory used by platform tables since the previous call.  This
+// is a no-op in release builds.
+void ReportWorldImages(void);
+
+// Log size of World, and the maximum number of platforms, springs, and
+// meteors used since the previous call.  This is a no-op in release builds.
+void ReportWorldMemory(void);
+
 // Reset world to initial state.
 void ResetWorld(World *world);
 
 // Run a single time step of world+slime updates and render world.
 void UpdateWorld(World *world);
 
+// Returns 1 if calling UpdateWorld without any input would not cause any
+// visible changes, i.e. slime is at rest, there are no live meteors, no
+// moving platforms in view, and camera has settled.
+int IsWorldAtRest(const World *world);
+
+// Get width of a platform's collision rectangle from platform type.
+int GetPlatformWidth(int type);
+
 // Draw updated world.
 void DrawWorld(const World *world, PlaydateAPI *pd);
 